@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <functional>
+#include "httplib.h"
+
+// Keep-alive HTTPS clients for one provider host, reused across requests so
+// calls skip the TCP and TLS handshakes. An httplib client runs one request at
+// a time, so each caller leases its own: lease() hands out an idle client or
+// opens a new one, and the lease puts it back when it goes out of scope (at
+// most `max_idle` are kept).
+class ClientPool {
+public:
+    using Configure = std::function<void(httplib::SSLClient&)>;
+
+    class Lease {
+    public:
+        Lease(ClientPool* pool, std::unique_ptr<httplib::SSLClient> client)
+            : pool(pool), client(std::move(client)) {}
+        Lease(Lease&&) = default;
+        Lease& operator=(Lease&&) = default;
+        ~Lease() {
+            if (pool && client) pool->release(std::move(client));
+        }
+
+        httplib::SSLClient* operator->() const { return client.get(); }
+        httplib::SSLClient& operator*() const { return *client; }
+
+    private:
+        ClientPool* pool;
+        std::unique_ptr<httplib::SSLClient> client;
+    };
+
+    ClientPool(std::string host, int port, Configure configure, size_t max_idle = 16)
+        : host(std::move(host)), port(port), configure(std::move(configure)), max_idle(max_idle) {}
+
+    Lease lease() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!idle.empty()) {
+                auto client = std::move(idle.back());
+                idle.pop_back();
+                return Lease(this, std::move(client));
+            }
+        }
+        auto client = std::make_unique<httplib::SSLClient>(host, port);
+        client->set_keep_alive(true);
+        if (configure) configure(*client);
+        return Lease(this, std::move(client));
+    }
+
+    const std::string& host_name() const { return host; }
+
+private:
+    std::string host;
+    int port;
+    Configure configure;
+    size_t max_idle;
+    std::vector<std::unique_ptr<httplib::SSLClient>> idle;
+    std::mutex mutex;
+
+    void release(std::unique_ptr<httplib::SSLClient> client) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (idle.size() < max_idle) idle.push_back(std::move(client));
+    }
+};
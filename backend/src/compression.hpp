@@ -0,0 +1,295 @@
+#pragma once
+
+#include <string>
+#include <cstdlib>
+#include <stdexcept>
+#include <initializer_list>
+#include <memory>
+#include <algorithm>
+
+#ifdef SIGNING_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef SIGNING_HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+#ifdef SIGNING_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+// Content-Encoding support shared by the static file cache and the API routes.
+// Each codec is optional and only compiled in when CMake found the library.
+
+enum class ContentEncoding { Identity, Gzip, Brotli, Zstd };
+
+inline const char* content_encoding_token(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::Gzip: return "gzip";
+        case ContentEncoding::Brotli: return "br";
+        case ContentEncoding::Zstd: return "zstd";
+        default: return "identity";
+    }
+}
+
+inline bool encoding_available(ContentEncoding encoding) {
+    switch (encoding) {
+#ifdef SIGNING_HAVE_ZLIB
+        case ContentEncoding::Gzip: return true;
+#endif
+#ifdef SIGNING_HAVE_BROTLI
+        case ContentEncoding::Brotli: return true;
+#endif
+#ifdef SIGNING_HAVE_ZSTD
+        case ContentEncoding::Zstd: return true;
+#endif
+        case ContentEncoding::Identity: return true;
+        default: return false;
+    }
+}
+
+// Returns the q-value the client assigned to `token` in an Accept-Encoding header,
+// or -1 when the token is not listed (a "*" entry counts for unlisted codings).
+inline double accept_encoding_qvalue(const std::string& header, const std::string& token) {
+    double wildcard = -1;
+    size_t pos = 0;
+    while (pos < header.size()) {
+        size_t comma = header.find(',', pos);
+        if (comma == std::string::npos) comma = header.size();
+        std::string item = header.substr(pos, comma - pos);
+        pos = comma + 1;
+
+        double q = 1.0;
+        size_t semi = item.find(';');
+        if (semi != std::string::npos) {
+            size_t qpos = item.find("q=", semi);
+            if (qpos != std::string::npos) q = std::atof(item.c_str() + qpos + 2);
+            item.erase(semi);
+        }
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+
+        if (item == token) return q;
+        if (item == "*") wildcard = q;
+    }
+    return wildcard;
+}
+
+// Picks the best coding the client accepts from `candidates`, in server
+// preference order on ties. Falls back to identity.
+inline ContentEncoding negotiate_encoding(const std::string& accept_encoding,
+                                          std::initializer_list<ContentEncoding> candidates) {
+    ContentEncoding best = ContentEncoding::Identity;
+    double best_q = 0;
+    for (auto candidate : candidates) {
+        if (!encoding_available(candidate)) continue;
+        double q = accept_encoding_qvalue(accept_encoding, content_encoding_token(candidate));
+        if (q > best_q) {
+            best = candidate;
+            best_q = q;
+        }
+    }
+    return best;
+}
+
+inline bool is_compressible_content_type(const std::string& content_type) {
+    return content_type.rfind("text/", 0) == 0 ||
+           content_type.rfind("application/json", 0) == 0 ||
+           content_type.rfind("application/javascript", 0) == 0 ||
+           content_type.rfind("application/xml", 0) == 0 ||
+           content_type.rfind("image/svg+xml", 0) == 0;
+}
+
+#ifdef SIGNING_HAVE_ZLIB
+inline std::string compress_gzip(const std::string& input, int level = Z_BEST_COMPRESSION) {
+    z_stream strm{};
+    // windowBits 15 + 16 selects the gzip wrapper
+    if (deflateInit2(&strm, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("deflateInit2 failed");
+    }
+
+    std::string output;
+    output.resize(deflateBound(&strm, input.size()));
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    strm.avail_in = static_cast<uInt>(input.size());
+    strm.next_out = reinterpret_cast<Bytef*>(&output[0]);
+    strm.avail_out = static_cast<uInt>(output.size());
+
+    int ret = deflate(&strm, Z_FINISH);
+    output.resize(strm.total_out);
+    deflateEnd(&strm);
+    if (ret != Z_STREAM_END) {
+        throw std::runtime_error("gzip compression failed");
+    }
+    return output;
+}
+#endif
+
+#ifdef SIGNING_HAVE_BROTLI
+inline std::string compress_brotli(const std::string& input, int quality = BROTLI_MAX_QUALITY) {
+    size_t encoded_size = BrotliEncoderMaxCompressedSize(input.size());
+    if (encoded_size == 0) encoded_size = input.size() + 1024;
+
+    std::string output(encoded_size, '\0');
+    if (!BrotliEncoderCompress(quality, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                               input.size(), reinterpret_cast<const uint8_t*>(input.data()),
+                               &encoded_size, reinterpret_cast<uint8_t*>(&output[0]))) {
+        throw std::runtime_error("brotli compression failed");
+    }
+    output.resize(encoded_size);
+    return output;
+}
+#endif
+
+// Incremental compressor for responses produced in pieces (chunked listings).
+// `level` uses each codec's native scale; callers pass a 1-9 style value,
+// which is valid for gzip, brotli and zstd alike.
+class StreamCompressor {
+private:
+    ContentEncoding encoding;
+#ifdef SIGNING_HAVE_ZLIB
+    z_stream zs{};
+#endif
+#ifdef SIGNING_HAVE_BROTLI
+    BrotliEncoderState* br = nullptr;
+#endif
+#ifdef SIGNING_HAVE_ZSTD
+    ZSTD_CCtx* zc = nullptr;
+#endif
+
+public:
+    StreamCompressor(ContentEncoding encoding, int level) : encoding(encoding) {
+        switch (encoding) {
+#ifdef SIGNING_HAVE_ZLIB
+            case ContentEncoding::Gzip:
+                if (deflateInit2(&zs, std::clamp(level, 1, 9), Z_DEFLATED, 15 + 16, 8,
+                                 Z_DEFAULT_STRATEGY) != Z_OK) {
+                    throw std::runtime_error("deflateInit2 failed");
+                }
+                break;
+#endif
+#ifdef SIGNING_HAVE_BROTLI
+            case ContentEncoding::Brotli:
+                br = BrotliEncoderCreateInstance(nullptr, nullptr, nullptr);
+                if (!br) throw std::runtime_error("BrotliEncoderCreateInstance failed");
+                BrotliEncoderSetParameter(br, BROTLI_PARAM_QUALITY, std::clamp(level, 0, 11));
+                BrotliEncoderSetParameter(br, BROTLI_PARAM_MODE, BROTLI_MODE_TEXT);
+                break;
+#endif
+#ifdef SIGNING_HAVE_ZSTD
+            case ContentEncoding::Zstd:
+                zc = ZSTD_createCCtx();
+                if (!zc) throw std::runtime_error("ZSTD_createCCtx failed");
+                ZSTD_CCtx_setParameter(zc, ZSTD_c_compressionLevel, std::clamp(level, 1, 19));
+                break;
+#endif
+            default:
+                break;
+        }
+    }
+
+    ~StreamCompressor() {
+#ifdef SIGNING_HAVE_ZLIB
+        if (encoding == ContentEncoding::Gzip) deflateEnd(&zs);
+#endif
+#ifdef SIGNING_HAVE_BROTLI
+        if (br) BrotliEncoderDestroyInstance(br);
+#endif
+#ifdef SIGNING_HAVE_ZSTD
+        if (zc) ZSTD_freeCCtx(zc);
+#endif
+    }
+
+    StreamCompressor(const StreamCompressor&) = delete;
+    StreamCompressor& operator=(const StreamCompressor&) = delete;
+
+    // Appends the compressed form of `data` to `out`. `last` finishes the stream.
+    void compress(const char* data, size_t length, bool last, std::string& out) {
+        char buf[16384];
+        switch (encoding) {
+#ifdef SIGNING_HAVE_ZLIB
+            case ContentEncoding::Gzip: {
+                zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+                zs.avail_in = static_cast<uInt>(length);
+                int flush = last ? Z_FINISH : Z_NO_FLUSH;
+                int ret;
+                do {
+                    zs.next_out = reinterpret_cast<Bytef*>(buf);
+                    zs.avail_out = sizeof(buf);
+                    ret = deflate(&zs, flush);
+                    if (ret == Z_STREAM_ERROR) throw std::runtime_error("gzip compression failed");
+                    out.append(buf, sizeof(buf) - zs.avail_out);
+                } while (zs.avail_out == 0 || (last && ret != Z_STREAM_END));
+                return;
+            }
+#endif
+#ifdef SIGNING_HAVE_BROTLI
+            case ContentEncoding::Brotli: {
+                size_t avail_in = length;
+                auto next_in = reinterpret_cast<const uint8_t*>(data);
+                auto op = last ? BROTLI_OPERATION_FINISH : BROTLI_OPERATION_PROCESS;
+                while (true) {
+                    size_t avail_out = sizeof(buf);
+                    auto next_out = reinterpret_cast<uint8_t*>(buf);
+                    if (!BrotliEncoderCompressStream(br, op, &avail_in, &next_in,
+                                                     &avail_out, &next_out, nullptr)) {
+                        throw std::runtime_error("brotli compression failed");
+                    }
+                    out.append(buf, sizeof(buf) - avail_out);
+                    if (avail_in == 0 && !BrotliEncoderHasMoreOutput(br) &&
+                        (!last || BrotliEncoderIsFinished(br))) {
+                        return;
+                    }
+                }
+            }
+#endif
+#ifdef SIGNING_HAVE_ZSTD
+            case ContentEncoding::Zstd: {
+                ZSTD_inBuffer input = {data, length, 0};
+                auto mode = last ? ZSTD_e_end : ZSTD_e_continue;
+                while (true) {
+                    ZSTD_outBuffer output = {buf, sizeof(buf), 0};
+                    size_t remaining = ZSTD_compressStream2(zc, &output, &input, mode);
+                    if (ZSTD_isError(remaining)) throw std::runtime_error("zstd compression failed");
+                    out.append(buf, output.pos);
+                    if (last ? remaining == 0 : input.pos == input.size) return;
+                }
+            }
+#endif
+            default:
+                out.append(data, length);
+                return;
+        }
+    }
+};
+
+inline std::string compress_buffer(ContentEncoding encoding, const std::string& input, int level) {
+    std::string out;
+    StreamCompressor compressor(encoding, level);
+    compressor.compress(input.data(), input.size(), true, out);
+    return out;
+}
+
+// Per-route knobs: bodies under `min_bytes` are sent as-is (the framing
+// overhead is not worth it), `level` 0 disables compression for the route.
+struct CompressionPolicy {
+    size_t min_bytes = 1024;
+    int level = 5;
+
+    // Reads <PREFIX>_MIN_BYTES and <PREFIX>_LEVEL, keeping `defaults` for unset values
+    static CompressionPolicy from_env(const std::string& prefix, CompressionPolicy defaults) {
+        if (const char* v = std::getenv((prefix + "_MIN_BYTES").c_str())) {
+            defaults.min_bytes = std::strtoul(v, nullptr, 10);
+        }
+        if (const char* v = std::getenv((prefix + "_LEVEL").c_str())) {
+            defaults.level = std::atoi(v);
+        }
+        return defaults;
+    }
+
+    ContentEncoding choose(const std::string& accept_encoding) const {
+        if (level <= 0) return ContentEncoding::Identity;
+        // zstd first: best speed/ratio for on-the-fly compression
+        return negotiate_encoding(accept_encoding,
+                                  {ContentEncoding::Zstd, ContentEncoding::Brotli, ContentEncoding::Gzip});
+    }
+};
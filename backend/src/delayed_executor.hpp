@@ -0,0 +1,73 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include "httplib.h"
+
+// Runs tasks at a given time on a few worker threads. One timer thread holds
+// the tasks that aren't due yet, so scheduling work that usually turns out
+// unnecessary (a hedge the original request answers before) costs a map entry
+// instead of a thread. Threads start with the first task. Destruction drops
+// the tasks not yet due and waits for those already handed to a worker.
+class DelayedExecutor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit DelayedExecutor(size_t workers) : worker_count(workers) {}
+
+    ~DelayedExecutor() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        due.notify_all();
+        if (timer.joinable()) timer.join();
+        if (workers) workers->shutdown();
+    }
+
+    DelayedExecutor(const DelayedExecutor&) = delete;
+    DelayedExecutor& operator=(const DelayedExecutor&) = delete;
+
+    void schedule(Clock::time_point at, std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) return;
+            if (!workers) {
+                workers = std::make_unique<httplib::ThreadPool>(worker_count);
+                timer = std::thread([this] { run(); });
+            }
+            pending.emplace(at, std::move(task));
+        }
+        due.notify_one();
+    }
+
+private:
+    size_t worker_count;
+    std::multimap<Clock::time_point, std::function<void()>> pending;
+    std::unique_ptr<httplib::ThreadPool> workers;
+    std::thread timer;
+    std::mutex mutex;
+    std::condition_variable due;
+    bool stopping = false;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            if (pending.empty()) {
+                due.wait(lock);
+                continue;
+            }
+            auto next = pending.begin()->first;
+            if (Clock::now() < next) {
+                due.wait_until(lock, next);
+                continue;
+            }
+            workers->enqueue(std::move(pending.extract(pending.begin()).mapped()));
+        }
+    }
+};
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <unordered_set>
+#include <unordered_map>
+#include <map>
+#include <malloc.h>
+#include "json.hpp"
+#include "session_id.hpp"
+#include "signing_session.hpp"
+#include "session_store.hpp"
+#include "session_snapshot.hpp"
+#include "session_wal.hpp"
+#include "session_expiry.hpp"
+
+// Offline diagnostics, run from the command line instead of starting the server:
+//   signing-server --bench-session-ids [count] [threads]
+//   signing-server --memory-report [count]
+//   signing-server --warm-start-report [count] [dir]
+
+namespace diagnostics {
+
+inline double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Throughput of SessionId generation (single and multi-threaded), store hash
+// lookups versus the old string keys, and a collision check of both generators.
+inline int bench_session_ids(size_t count, unsigned threads) {
+    std::cout << "Session ID benchmark: " << count << " IDs, " << threads << " threads" << std::endl;
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        volatile uint64_t sink = 0;
+        for (size_t i = 0; i < count; i++) sink = sink ^ SessionId::generate().lo;
+        double secs = seconds_since(start);
+        std::cout << "  generate (1 thread):   " << std::fixed << std::setprecision(1)
+                  << count / secs / 1e6 << " M ids/s" << std::endl;
+    }
+
+    {
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back([count, threads] {
+                volatile uint64_t sink = 0;
+                for (size_t i = 0; i < count / threads; i++) sink = sink ^ SessionId::generate().lo;
+            });
+        }
+        for (auto& w : workers) w.join();
+        double secs = seconds_since(start);
+        std::cout << "  generate (" << threads << " threads):  " << count / secs / 1e6 << " M ids/s" << std::endl;
+    }
+
+    std::vector<SessionId> ids;
+    ids.reserve(count);
+    for (size_t i = 0; i < count; i++) ids.push_back(SessionId::generate());
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        size_t chars = 0;
+        for (const auto& id : ids) chars += id.to_chars().size();
+        double secs = seconds_since(start);
+        std::cout << "  format to hex:         " << count / secs / 1e6 << " M ids/s ("
+                  << chars / count << " chars, no allocation)" << std::endl;
+    }
+
+    // Store-style lookups: binary keys with the folding hash vs. std::string keys
+    {
+        std::unordered_map<SessionId, int, SessionIdHash> binary_map;
+        std::unordered_map<std::string, int> string_map;
+        std::vector<std::string> texts;
+        texts.reserve(count);
+        for (const auto& id : ids) {
+            binary_map.emplace(id, 0);
+            texts.push_back(id.str());
+            string_map.emplace(texts.back(), 0);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        size_t hits = 0;
+        for (const auto& id : ids) hits += binary_map.count(id);
+        double binary_secs = seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        for (const auto& text : texts) hits += string_map.count(text);
+        double string_secs = seconds_since(start);
+
+        std::cout << "  lookup SessionId key:  " << count / binary_secs / 1e6 << " M/s" << std::endl;
+        std::cout << "  lookup string key:     " << count / string_secs / 1e6 << " M/s"
+                  << (hits == 2 * count ? "" : " (lookup mismatch!)") << std::endl;
+    }
+
+    // Collision check
+    size_t collisions = 0;
+    {
+        std::unordered_set<SessionId, SessionIdHash> seen;
+        seen.reserve(count);
+        for (const auto& id : ids) {
+            if (!seen.insert(id).second) collisions++;
+        }
+    }
+
+    size_t legacy_collisions = 0;
+    {
+        // The previous generator: a 6-digit number from a shared mt19937
+        std::mt19937 gen(std::random_device{}());
+        std::uniform_int_distribution<> dis(100000, 999999);
+        std::unordered_set<int> seen;
+        for (size_t i = 0; i < count; i++) {
+            if (!seen.insert(dis(gen)).second) legacy_collisions++;
+        }
+    }
+
+    std::cout << "  collisions (128-bit):  " << collisions << std::endl;
+    std::cout << "  collisions (6-digit):  " << legacy_collisions << std::endl;
+    return collisions == 0 ? 0 : 1;
+}
+
+// Bytes currently allocated from the heap (0 where glibc's mallinfo2 is missing)
+inline size_t heap_in_use() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+// The SigningSession layout before the compact representation, kept here only
+// so the report can measure it
+struct LegacySigningSession {
+    std::string id;
+    std::string signature_request_id;
+    std::string signature_id;
+    std::string status;
+    nlohmann::json signer_info;
+    nlohmann::json boldsign_response;
+    int64_t created_at;
+};
+
+// Measures heap bytes per session for the legacy layout (std::map of strings and
+// json), the compact record in a plain hash map, and the full SessionStore with
+// all of its indexes. Values mimic real traffic: 40-char Dropbox Sign IDs and
+// typical signer details.
+inline int memory_report(size_t count) {
+    const std::string name = "Jane Q. Signer";
+    const std::string phone = "+1 555 0100";
+    auto email_for = [](size_t i) { return "signer" + std::to_string(i) + "@example.com"; };
+    auto provider_id = [](const SessionId& id) { return id.str() + "c0ffee42"; };
+
+    auto report = [count](const char* label, size_t record_size, size_t bytes) {
+        std::cout << "  " << std::left << std::setw(34) << label << std::right
+                  << "sizeof " << std::setw(3) << record_size << "  "
+                  << std::setw(6) << bytes / count << " B/session  "
+                  << std::fixed << std::setprecision(1) << bytes / 1048576.0 << " MB" << std::endl;
+    };
+
+    if (heap_in_use() == 0) {
+        std::cout << "Heap accounting needs glibc 2.33+ (mallinfo2)" << std::endl;
+        return 1;
+    }
+    std::cout << "Session memory at " << count << " sessions" << std::endl;
+
+    {
+        size_t before = heap_in_use();
+        std::map<std::string, LegacySigningSession> legacy;
+        for (size_t i = 0; i < count; i++) {
+            SessionId id = SessionId::generate();
+            LegacySigningSession session;
+            session.id = std::to_string(100000 + i);
+            session.signature_request_id = provider_id(id);
+            session.signature_id = provider_id(SessionId::generate());
+            session.status = "pending";
+            session.signer_info = {{"name", name}, {"email", email_for(i)}, {"phone", phone}};
+            session.created_at = std::chrono::system_clock::now().time_since_epoch().count();
+            legacy.emplace(session.id, std::move(session));
+        }
+        report("before: std::map + strings/json", sizeof(LegacySigningSession), heap_in_use() - before);
+    }
+
+    std::vector<SigningSession> sessions;
+    sessions.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        SigningSession session;
+        session.id = SessionId::generate();
+        session.set_fields(provider_id(session.id), provider_id(SessionId::generate()),
+                           name, email_for(i), phone);
+        session.created_at = SessionClock::now();
+        sessions.push_back(std::move(session));
+    }
+
+    {
+        size_t before = heap_in_use();
+        std::unordered_map<SessionId, SigningSession, SessionIdHash> compact;
+        compact.reserve(count);
+        for (const auto& session : sessions) compact.emplace(session.id, session);
+        report("after: compact record + hash map", sizeof(SigningSession), heap_in_use() - before);
+    }
+
+    {
+        size_t before = heap_in_use();
+        auto store = std::make_unique<SessionStore>();
+        for (const auto& session : sessions) store->insert(session);
+        report("after: SessionStore incl. indexes", sizeof(SigningSession), heap_in_use() - before);
+    }
+    return 0;
+}
+
+// Restart-to-serving time with `count` sessions: replaying them from a log
+// versus mapping a snapshot, then the first queries against the mapped store
+// (which fault its pages in). Re-arming every expiry timer, which the server
+// does in the background after it starts serving, is timed separately. Files
+// go to `dir`; the page cache is warm, as after a quick restart.
+inline int warm_start_report(size_t count, const std::string& dir) {
+    auto ms_since = [](std::chrono::steady_clock::time_point start) {
+        return seconds_since(start) * 1000.0;
+    };
+    std::cout << "Warm start with " << count << " sessions (" << dir << ")" << std::endl;
+    std::filesystem::create_directories(dir);
+    const std::string log_path = dir + "/warm-start.log";
+    const std::string snapshot_path = dir + "/warm-start.snapshot";
+
+    std::vector<SessionId> ids;
+    {
+        SessionStore store;
+        ids.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            SigningSession session;
+            session.id = SessionId::generate();
+            session.created_at = static_cast<uint32_t>(i / 16);
+            session.status = i % 4 == 0 ? SessionStatus::Signed : SessionStatus::Pending;
+            session.set_fields(session.id.str() + "c0ffee42", SessionId::generate().str(), "Jane Q. Signer",
+                               "signer" + std::to_string(i) + "@example.com", "+1 555 0100");
+            ids.push_back(session.id);
+            store.insert(std::move(session));
+        }
+
+        std::string log;
+        SnapshotBuilder builder;
+        store.for_each([] {}, [&](const SessionRecordRef& session) {
+            wal_record::encode_insert(log, SigningSession::from_ref(session));
+            builder.add(session);
+        });
+        std::ofstream(log_path, std::ios::binary).write(log.data(), log.size());
+        int fd = ::open(snapshot_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        bool ok = fd >= 0 && builder.write(fd);
+        if (fd >= 0) ::close(fd);
+        if (!ok) {
+            std::cout << "Cannot write " << snapshot_path << std::endl;
+            return 1;
+        }
+        std::cout << "  log " << log.size() / 1048576 << " MB, snapshot "
+                  << std::filesystem::file_size(snapshot_path) / 1048576 << " MB" << std::endl;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    {
+        auto start = std::chrono::steady_clock::now();
+        SessionStore store;
+        std::ifstream file(log_path, std::ios::binary);
+        std::string log((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        wal_record::apply(log.data(), log.size(), store);
+        std::cout << "  replay full log:          " << std::setw(8) << ms_since(start) << " ms ("
+                  << store.size() << " sessions)" << std::endl;
+    }
+
+    auto restart = std::chrono::steady_clock::now();
+    SessionStore store;
+    store.attach_base(MappedSnapshot::open(snapshot_path));
+    std::cout << "  map snapshot:             " << std::setw(8) << ms_since(restart) << " ms" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    std::mt19937_64 rng(42);
+    size_t hits = 0;
+    for (int i = 0; i < 1000; i++) hits += store.find(ids[rng() % ids.size()]).has_value();
+    SessionQuery query;
+    query.status = SessionStatus::Signed;
+    hits += store.list(query).sessions.size() == query.limit;
+    hits += store.find_by_signer_email("SIGNER7@example.com").size();
+    hits += store.update_status(ids[0], SessionStatus::Signed);
+    std::cout << "  first 1003 queries:       " << std::setw(8) << ms_since(start) << " ms"
+              << (hits == 1003 ? "" : " (unexpected results!)") << std::endl;
+    std::cout << "  restart to serving:       " << std::setw(8) << ms_since(restart) << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    SessionExpiry expiry([](const std::vector<SessionId>&) {});
+    store.for_each_mapped(0, store.size(), [&](const SessionRecordRef& session) {
+        expiry.schedule(session.id, session.status);
+    });
+    std::cout << "  re-arm timers (background): " << std::setw(6) << ms_since(start) << " ms" << std::endl;
+
+    std::filesystem::remove(log_path);
+    std::filesystem::remove(snapshot_path);
+    return hits == 1003 ? 0 : 1;
+}
+
+}  // namespace diagnostics
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <optional>
+#include <iostream>
+#include "http_util.hpp"
+
+// Signed PDFs are immutable once the provider reports completion, so we keep
+// a bounded in-memory copy and serve conditional/range requests from it.
+struct CachedDocument {
+    std::string content;
+    std::string etag;
+    std::time_t last_modified;
+};
+
+class DocumentCache {
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<const CachedDocument>>;
+
+    std::list<Entry> lru;  // front = most recently used
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    size_t total_bytes = 0;
+    size_t max_bytes;
+    std::mutex mutex;
+
+    void evict_locked() {
+        while (total_bytes > max_bytes && !lru.empty()) {
+            auto& victim = lru.back();
+            total_bytes -= victim.second->content.size();
+            index.erase(victim.first);
+            lru.pop_back();
+        }
+    }
+
+public:
+    explicit DocumentCache(size_t max_bytes = 256 * 1024 * 1024) : max_bytes(max_bytes) {}
+
+    static std::shared_ptr<CachedDocument> make_document(std::string content) {
+        auto doc = std::make_shared<CachedDocument>();
+        doc->etag = make_strong_etag(sha256_hex(content));
+        doc->content = std::move(content);
+        doc->last_modified = std::time(nullptr);
+        return doc;
+    }
+
+    std::shared_ptr<const CachedDocument> get(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) return nullptr;
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->second;
+    }
+
+    void put(const std::string& key, std::shared_ptr<const CachedDocument> doc) {
+        // Never let a single document flush the whole cache
+        if (doc->content.size() > max_bytes / 4) return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            total_bytes -= it->second->second->content.size();
+            lru.erase(it->second);
+            index.erase(it);
+        }
+        lru.emplace_front(key, doc);
+        index[key] = lru.begin();
+        total_bytes += doc->content.size();
+        evict_locked();
+    }
+
+    void erase(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) return;
+        total_bytes -= it->second->second->content.size();
+        lru.erase(it->second);
+        index.erase(it);
+    }
+};
+
+// ETag and Last-Modified of signed documents downloaded before, kept apart
+// from the bytes so a conditional request can be answered after the document
+// was evicted (or the server restarted) without downloading it again, and so
+// Last-Modified stays the time we first saw it. Given a path, entries are
+// appended to a log ("<key> <unix time> <etag>", or "<key> -" once forgotten)
+// that is rewritten without the dead lines when loaded.
+class DocumentValidators {
+public:
+    struct Validators {
+        std::string etag;
+        std::time_t last_modified = 0;
+    };
+
+    explicit DocumentValidators(std::string path = "") : path(std::move(path)) {
+        if (this->path.empty()) return;
+        size_t lines = load();
+        if (lines > 2 * entries.size() + 1024) compact();
+        log.open(this->path, std::ios::app);
+        if (!log) std::cerr << "Cannot write document validators to " << this->path << std::endl;
+    }
+
+    std::optional<Validators> get(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it == entries.end()) return std::nullopt;
+        return it->second;
+    }
+
+    // Records a downloaded document and returns its Last-Modified: the time
+    // first recorded for this content, otherwise `now`
+    std::time_t remember(const std::string& key, const std::string& etag, std::time_t now) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it != entries.end() && it->second.etag == etag) return it->second.last_modified;
+        entries[key] = Validators{etag, now};
+        if (log) log << key << ' ' << now << ' ' << etag << std::endl;
+        return now;
+    }
+
+    void forget(const std::vector<std::string>& keys) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& key : keys) {
+            if (entries.erase(key) && log) log << key << " -\n";
+        }
+        log.flush();
+    }
+
+private:
+    std::string path;
+    std::unordered_map<std::string, Validators> entries;
+    std::ofstream log;
+    std::mutex mutex;
+
+    // Replays the log; returns how many lines it had
+    size_t load() {
+        std::ifstream file(path);
+        std::string line;
+        size_t lines = 0;
+        while (std::getline(file, line)) {
+            lines++;
+            std::istringstream fields(line);
+            std::string key, modified, etag;
+            if (!(fields >> key >> modified)) continue;
+            if (modified == "-") {
+                entries.erase(key);
+            } else if (fields >> etag) {
+                entries[key] = Validators{etag, static_cast<std::time_t>(std::strtoll(modified.c_str(), nullptr, 10))};
+            }
+        }
+        return lines;
+    }
+
+    void compact() {
+        std::string temp = path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::trunc);
+            for (const auto& [key, v] : entries) out << key << ' ' << v.last_modified << ' ' << v.etag << '\n';
+            if (!out.flush()) return;
+        }
+        std::rename(temp.c_str(), path.c_str());
+    }
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <string>
+#include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <openssl/sha.h>
+
+// Small HTTP helpers shared by the download and static file routes.
+
+inline std::string sha256_hex(const std::string& data) {
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char*>(data.data()), data.size(), digest);
+
+    static const char* hex = "0123456789abcdef";
+    std::string out;
+    out.reserve(SHA256_DIGEST_LENGTH * 2);
+    for (unsigned char b : digest) {
+        out += hex[b >> 4];
+        out += hex[b & 0x0f];
+    }
+    return out;
+}
+
+// Strong entity tag built from a content hash. 32 hex chars (128 bits) is plenty
+// to tell document versions apart and keeps the header short.
+inline std::string make_strong_etag(const std::string& content_hash) {
+    return "\"" + content_hash.substr(0, 32) + "\"";
+}
+
+// RFC 7231 IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+inline std::string format_http_date(std::time_t t) {
+    std::tm tm{};
+#ifdef _WIN32
+    gmtime_s(&tm, &t);
+#else
+    gmtime_r(&t, &tm);
+#endif
+    char buf[64];
+    std::strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return buf;
+}
+
+// ISO 8601 UTC timestamp, e.g. "1994-11-06T08:49:37Z"
+inline std::string format_iso8601_utc(std::time_t t) {
+    std::tm tm{};
+#ifdef _WIN32
+    gmtime_s(&tm, &t);
+#else
+    gmtime_r(&t, &tm);
+#endif
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    return buf;
+}
+
+// Parses IMF-fixdate only (the format every current browser sends).
+// Returns -1 when the value cannot be parsed.
+inline std::time_t parse_http_date(const std::string& value) {
+    static const char* months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                   "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    char wday[4] = {0}, mon[4] = {0};
+    int day = 0, year = 0, hour = 0, min = 0, sec = 0;
+    if (std::sscanf(value.c_str(), "%3s, %d %3s %d %d:%d:%d GMT",
+                    wday, &day, mon, &year, &hour, &min, &sec) != 7) {
+        return -1;
+    }
+
+    std::tm tm{};
+    tm.tm_mon = -1;
+    for (int i = 0; i < 12; i++) {
+        if (std::strcmp(mon, months[i]) == 0) {
+            tm.tm_mon = i;
+            break;
+        }
+    }
+    if (tm.tm_mon < 0) return -1;
+
+    tm.tm_mday = day;
+    tm.tm_year = year - 1900;
+    tm.tm_hour = hour;
+    tm.tm_min = min;
+    tm.tm_sec = sec;
+#ifdef _WIN32
+    return _mkgmtime(&tm);
+#else
+    return timegm(&tm);
+#endif
+}
+
+// Checks an If-None-Match style list ("*", or comma separated tags).
+// Uses weak comparison as required for If-None-Match, so W/"x" matches "x".
+inline bool etag_list_matches(const std::string& header, const std::string& etag) {
+    if (header.empty()) return false;
+
+    auto strip_weak = [](std::string tag) {
+        if (tag.compare(0, 2, "W/") == 0) tag.erase(0, 2);
+        return tag;
+    };
+    const std::string wanted = strip_weak(etag);
+
+    size_t pos = 0;
+    while (pos < header.size()) {
+        size_t comma = header.find(',', pos);
+        if (comma == std::string::npos) comma = header.size();
+
+        std::string tag = header.substr(pos, comma - pos);
+        tag.erase(0, tag.find_first_not_of(" \t"));
+        tag.erase(tag.find_last_not_of(" \t") + 1);
+
+        if (tag == "*" || strip_weak(tag) == wanted) return true;
+        pos = comma + 1;
+    }
+    return false;
+}
+
+// If-Range needs a strong match on the tag, or an exact Last-Modified date.
+inline bool if_range_matches(const std::string& header, const std::string& etag,
+                             std::time_t last_modified) {
+    if (header.empty()) return true;
+    if (header.front() == '"') return header == etag;
+    if (header.compare(0, 2, "W/") == 0) return false;
+    return parse_http_date(header) == last_modified;
+}
+
+inline std::string base64_encode(const std::string& input) {
+    static const char* base64_chars = 
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+        "abcdefghijklmnopqrstuvwxyz"
+        "0123456789+/";
+    
+    std::string output;
+    int i = 0;
+    unsigned char char_array_3[3];
+    unsigned char char_array_4[4];
+    int in_len = input.size();
+    const unsigned char* bytes_to_encode = reinterpret_cast<const unsigned char*>(input.c_str());
+    
+    while (in_len--) {
+        char_array_3[i++] = *(bytes_to_encode++);
+        if (i == 3) {
+            char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
+            char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
+            char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
+            char_array_4[3] = char_array_3[2] & 0x3f;
+            
+            for(i = 0; i < 4; i++)
+                output += base64_chars[char_array_4[i]];
+            i = 0;
+        }
+    }
+    
+    if (i) {
+        for(int j = i; j < 3; j++)
+            char_array_3[j] = '\0';
+        
+        char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
+        char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
+        char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
+        
+        for (int j = 0; j < i + 1; j++)
+            output += base64_chars[char_array_4[j]];
+        
+        while((i++ < 3))
+            output += '=';
+    }
+    
+    return output;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+// Results of requests made with an Idempotency-Key, so a retried POST replays
+// the original response instead of creating a second provider document.
+//
+// The first request with a key claims it (Proceed) and must later complete()
+// or abandon() it. Duplicates that arrive while it runs wait for that outcome.
+// Completed entries live for `ttl`; at most `max_entries` are kept, oldest
+// evicted first. A key reused with a different request body is a Mismatch.
+class IdempotencyCache {
+public:
+    struct StoredResponse {
+        int status = 200;
+        std::string body;
+        std::string content_type;
+    };
+
+    enum class Outcome { Proceed, Replay, Mismatch, InProgress };
+
+    struct Claim {
+        Outcome outcome;
+        StoredResponse response;  // set for Replay
+    };
+
+    IdempotencyCache(size_t max_entries, std::chrono::seconds ttl)
+        : max_entries(max_entries), ttl(ttl) {}
+
+    // `fingerprint` identifies the request payload (e.g. a hash of the body).
+    // Waits up to `wait` for an in-flight duplicate before giving up with InProgress.
+    Claim begin(const std::string& key, const std::string& fingerprint,
+                std::chrono::milliseconds wait = std::chrono::seconds(30)) {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto deadline = std::chrono::steady_clock::now() + wait;
+        while (true) {
+            auto it = index.find(key);
+            if (it != index.end() && it->second->done &&
+                std::chrono::steady_clock::now() >= it->second->expires_at) {
+                order.erase(it->second);
+                index.erase(it);
+                it = index.end();
+            }
+
+            if (it == index.end()) {
+                order.push_front(Entry{key, fingerprint});
+                index.emplace(key, order.begin());
+                evict_locked();
+                return {Outcome::Proceed, {}};
+            }
+
+            const Entry& entry = *it->second;
+            if (entry.fingerprint != fingerprint) return {Outcome::Mismatch, {}};
+            if (entry.done) return {Outcome::Replay, entry.response};
+
+            // The original is still running: wait for it to finish or be abandoned
+            if (finished.wait_until(lock, deadline) == std::cv_status::timeout) {
+                return {Outcome::InProgress, {}};
+            }
+        }
+    }
+
+    // Records the response of a claimed key for replay
+    void complete(const std::string& key, StoredResponse response) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = index.find(key);
+            if (it == index.end()) return;
+            it->second->done = true;
+            it->second->response = std::move(response);
+            it->second->expires_at = std::chrono::steady_clock::now() + ttl;
+        }
+        finished.notify_all();
+    }
+
+    // Releases a claimed key without a result, so the next attempt runs again
+    void abandon(const std::string& key) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = index.find(key);
+            if (it == index.end() || it->second->done) return;
+            order.erase(it->second);
+            index.erase(it);
+        }
+        finished.notify_all();
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return index.size();
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        std::string fingerprint;
+        bool done = false;
+        StoredResponse response{};
+        std::chrono::steady_clock::time_point expires_at{};
+    };
+
+    std::list<Entry> order;  // front = newest
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    size_t max_entries;
+    std::chrono::seconds ttl;
+    std::mutex mutex;
+    std::condition_variable finished;
+
+    // Drops expired entries from the old end, then the oldest completed ones
+    // while over capacity. In-flight entries are never evicted.
+    void evict_locked() {
+        auto now = std::chrono::steady_clock::now();
+        auto it = order.end();
+        while (it != order.begin()) {
+            --it;
+            bool expired = it->done && now >= it->expires_at;
+            bool over = index.size() > max_entries;
+            if (!expired && !over) break;
+            if (expired || it->done) {
+                index.erase(it->key);
+                it = order.erase(it);
+            }
+        }
+    }
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <chrono>
+#include <optional>
+#include <algorithm>
+
+// Latencies of the last `size` successful calls to one endpoint, for picking
+// a hedge delay from the endpoint's own distribution
+class LatencyWindow {
+public:
+    static constexpr size_t size = 64;
+    static constexpr size_t min_samples = 16;
+
+    void record(std::chrono::steady_clock::duration latency) {
+        std::lock_guard<std::mutex> lock(mutex);
+        samples[count % size] = std::chrono::duration_cast<std::chrono::milliseconds>(latency);
+        count++;
+    }
+
+    // The given percentile (0-100), once there are enough samples to trust it
+    std::optional<std::chrono::milliseconds> percentile(double p) {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t n = std::min(count, size);
+        if (n < min_samples) return std::nullopt;
+        std::array<std::chrono::milliseconds, size> sorted = samples;
+        auto at = sorted.begin() + std::min(n - 1, static_cast<size_t>(n * p / 100));
+        std::nth_element(sorted.begin(), at, sorted.begin() + n);
+        return *at;
+    }
+
+private:
+    std::array<std::chrono::milliseconds, size> samples{};
+    size_t count = 0;
+    std::mutex mutex;
+};
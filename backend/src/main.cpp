@@ -3,15 +3,32 @@
 #include <fstream>
 #include <sstream>
 #include <chrono>
-#include <random>
 #include <map>
 #include <mutex>
 #include <thread>
 #include <cstdlib>
 #include <regex>
 #include <algorithm>
+#include <memory>
 #include "httplib.h"
 #include "json.hpp"
+#include "http_util.hpp"
+#include "document_cache.hpp"
+#include "static_assets.hpp"
+#include "compression.hpp"
+#include "session_store.hpp"
+#include "session_expiry.hpp"
+#include "session_wal.hpp"
+#include "idempotency_cache.hpp"
+#include "client_pool.hpp"
+#include "parallel_batch.hpp"
+#include "status_freshness.hpp"
+#include "sign_url_cache.hpp"
+#include "zip_stream.hpp"
+#include "template_registry.hpp"
+#include "signature_provider.hpp"
+#include "provider_router.hpp"
+#include "diagnostics.hpp"
 
 using json = nlohmann::json;
 using namespace httplib;
@@ -63,37 +80,230 @@ void load_env_file(const std::string& filename = ".env") {
     }
 }
 
-struct SigningSession {
-    std::string id;
-    std::string signature_request_id;
-    std::string signature_id;
-    std::string status;
-    json signer_info;
-    json boldsign_response;
-    int64_t created_at;
-};
-
 class DocumentSigningServer {
 private:
     Server server;
-    std::map<std::string, SigningSession> signing_sessions;
-    std::mutex sessions_mutex;
-    std::string api_key;
-    std::string client_id;
-    std::string signature_provider;
-    bool is_demo_mode = false;
+    size_t server_threads = 64;        // handler threads; each blocks while its provider call is in flight
+    size_t server_max_queued = 0;      // connections waiting for a thread (0 = unbounded)
+    SessionStore session_store;
+    std::unique_ptr<SessionWal> session_wal;
+    std::unique_ptr<SessionExpiry> session_expiry;
+    std::thread mapped_expiry_thread;
+    std::unique_ptr<DocumentCache> document_cache;
+    std::unique_ptr<DocumentValidators> document_validators;
+    std::unique_ptr<IdempotencyCache> idempotency_cache;
+    using Providers = ProviderRouter<DropboxSignProvider, BoldSignProvider>;
+    std::unique_ptr<Providers> providers;
+    ProviderOptions provider_options;  // timeouts, breaker and concurrency limits per provider endpoint
+    std::chrono::milliseconds request_timeout{25000};  // deadline for one request's provider work
+    size_t batch_concurrency = 8;
+    size_t batch_workers = 32;  // threads shared by all batches and exports
+    std::unique_ptr<ThreadPool> batch_pool;
+    size_t batch_max_items = 1000;
+    std::unique_ptr<StatusFreshness> status_freshness;
+    std::chrono::milliseconds status_batch_deadline{5000};
+    size_t export_max_documents = 10000;
+    std::unique_ptr<TemplateRegistry> template_registry;  // null = upload the PDF with every session
+    std::unique_ptr<SignUrlCache> sign_url_cache;  // null = fetch a signing URL on every request
+    std::unique_ptr<StaticAssetCache> static_assets;
+    CompressionPolicy api_compression;
+    CompressionPolicy listing_compression;
+    
+    // Resolves a session ID taken from a URL; malformed IDs simply don't exist
+    std::optional<SigningSession> find_session(const std::string& session_id) {
+        auto id = SessionId::parse(session_id);
+        if (!id) return std::nullopt;
+        return session_store.find(*id);
+    }
+
+    static json signer_json(const SigningSession& session) {
+        return {
+            {"name", session.signer_name()},
+            {"email", session.signer_email()},
+            {"phone", session.signer_phone()}
+        };
+    }
+
+    // A provider call was refused by its circuit breaker or concurrency limit
+    static void respond_unavailable(Response& res, const ProviderUnavailable& e) {
+        res.status = 503;
+        res.set_header("Retry-After", std::to_string(e.retry_after.count()));
+        res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+    }
+
+    static void respond_deadline_exceeded(Response& res, const DeadlineExceeded& e) {
+        res.status = 504;
+        res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+    }
+
+    static void set_document_headers(Response& res, const std::string& etag, std::time_t last_modified) {
+        res.set_header("ETag", etag);
+        res.set_header("Last-Modified", format_http_date(last_modified));
+        res.set_header("Accept-Ranges", "bytes");
+        res.set_header("Cache-Control", "private, no-cache");
+    }
+
+    // Conditional GET: If-None-Match takes precedence over If-Modified-Since
+    static bool not_modified(const Request& req, const std::string& etag, std::time_t last_modified) {
+        if (req.has_header("If-None-Match")) {
+            return etag_list_matches(req.get_header_value("If-None-Match"), etag);
+        }
+        if (req.has_header("If-Modified-Since")) {
+            std::time_t since = parse_http_date(req.get_header_value("If-Modified-Since"));
+            return since != -1 && last_modified <= since;
+        }
+        return false;
+    }
+
+    // Compresses a finished JSON body when it is large enough and the client accepts it
+    static void compress_body(const Request& req, Response& res, const CompressionPolicy& policy) {
+        if (res.body.empty() || res.has_header("Content-Encoding")) return;
+        res.set_header("Vary", "Accept-Encoding");
+        if (res.body.size() < policy.min_bytes) return;
+        
+        ContentEncoding encoding = policy.choose(req.get_header_value("Accept-Encoding"));
+        if (encoding == ContentEncoding::Identity) return;
+        
+        res.body = compress_buffer(encoding, res.body, policy.level);
+        res.set_header("Content-Encoding", content_encoding_token(encoding));
+    }
     
-    std::string generate_session_id() {
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        static std::uniform_int_distribution<> dis(100000, 999999);
-        return std::to_string(dis(gen));
+    // Route wrapper applying a compression policy to everything the handler returns
+    Server::Handler compressed(const CompressionPolicy& policy, Server::Handler handler) {
+        return [&policy, handler](const Request& req, Response& res) {
+            handler(req, res);
+            compress_body(req, res, policy);
+        };
+    }
+
+    // Pending sessions resume their countdown from creation; a signed
+    // session's status change time isn't logged, so it gets a full TTL
+    void rearm_expiry(const SessionRecordRef& session, uint32_t now) {
+        int64_t age = 0;
+        if (session.status == SessionStatus::Pending && now > session.created_at) {
+            age = now - session.created_at;
+        }
+        session_expiry->schedule(session.id, session.status, age);
+    }
+    
+    // Maps the last snapshot, replays the log on top, re-arms expiry timers and starts logging
+    void restore_sessions(const std::string& wal_dir) {
+        SessionWal::Options options;
+        if (const char* env_mb = std::getenv("SESSION_WAL_SNAPSHOT_MB")) {
+            options.snapshot_bytes = std::strtoull(env_mb, nullptr, 10) * 1024 * 1024;
+        }
+        if (const char* env_interval = std::getenv("SESSION_WAL_SNAPSHOT_INTERVAL")) {
+            options.snapshot_interval = parse_duration_seconds(env_interval);
+            if (options.snapshot_interval < 0) {
+                throw std::runtime_error(std::string("Invalid SESSION_WAL_SNAPSHOT_INTERVAL value: ") + env_interval);
+            }
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        session_wal = std::make_unique<SessionWal>(wal_dir, options);
+        size_t restored = session_wal->recover(session_store);
+        
+        const uint32_t now = SessionClock::now();
+        session_store.for_each_loaded([&](const SessionRecordRef& session) {
+            rearm_expiry(session, now);
+        });
+        // Sessions still in the mapped snapshot are armed in the background so
+        // serving starts right away; each chunk holds the store's shared lock
+        mapped_expiry_thread = std::thread([this, now] {
+            const size_t chunk = 65536;
+            size_t total = 1;
+            try {
+                for (size_t begin = 0; begin < total; begin += chunk) {
+                    total = session_store.for_each_mapped(begin, begin + chunk, [&](const SessionRecordRef& session) {
+                        rearm_expiry(session, now);
+                    });
+                }
+            } catch (const std::exception& e) {
+                // Records are checked as they are read, not when the snapshot is opened
+                std::cerr << "Session expiry not re-armed for the whole snapshot: " << e.what() << std::endl;
+            }
+        });
+        session_wal->start(session_store);
+        
+        std::cout << "Restored " << restored << " sessions from " << wal_dir << " in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - start).count()
+                  << " ms" << std::endl;
     }
 
+    // Route wrapper giving the request a deadline for its provider calls:
+    // REQUEST_TIMEOUT, or less if the client sends X-Request-Timeout-Ms
+    Server::Handler deadline_bound(Server::Handler handler) {
+        return [this, handler](const Request& req, Response& res) {
+            auto timeout = request_timeout;
+            std::string header = req.get_header_value("X-Request-Timeout-Ms");
+            if (!header.empty() && std::all_of(header.begin(), header.end(), ::isdigit)) {
+                timeout = std::min(timeout, std::chrono::milliseconds(std::strtoull(header.c_str(), nullptr, 10)));
+            }
+            RequestDeadline::Scope scope(RequestDeadline::Clock::now() + timeout);
+            handler(req, res);
+        };
+    }
+    
+    // Route wrapper for Idempotency-Key: the first request with a key runs the
+    // handler, retries replay its response (unless it was a 5xx) and concurrent
+    // duplicates wait for the original to finish
+    Server::Handler idempotent(Server::Handler handler) {
+        return [this, handler](const Request& req, Response& res) {
+            std::string key = req.get_header_value("Idempotency-Key");
+            if (key.empty()) {
+                handler(req, res);
+                return;
+            }
+            if (key.size() > 255) {
+                setup_cors(res);
+                res.status = 400;
+                res.set_content("{\"error\":\"Idempotency-Key too long\"}", "application/json");
+                return;
+            }
+            
+            auto claim = idempotency_cache->begin(key, sha256_hex(req.body));
+            switch (claim.outcome) {
+                case IdempotencyCache::Outcome::Replay:
+                    setup_cors(res);
+                    res.status = claim.response.status;
+                    res.set_content(claim.response.body, claim.response.content_type);
+                    res.set_header("Idempotent-Replayed", "true");
+                    return;
+                case IdempotencyCache::Outcome::Mismatch:
+                    setup_cors(res);
+                    res.status = 422;
+                    res.set_content("{\"error\":\"Idempotency-Key was used with a different request\"}", "application/json");
+                    return;
+                case IdempotencyCache::Outcome::InProgress:
+                    setup_cors(res);
+                    res.status = 409;
+                    res.set_header("Retry-After", "1");
+                    res.set_content("{\"error\":\"A request with this Idempotency-Key is still in progress\"}", "application/json");
+                    return;
+                case IdempotencyCache::Outcome::Proceed:
+                    break;
+            }
+            
+            try {
+                handler(req, res);
+            } catch (...) {
+                idempotency_cache->abandon(key);
+                throw;
+            }
+            int status = res.status == -1 ? 200 : res.status;
+            if (status >= 500) {
+                idempotency_cache->abandon(key);
+            } else {
+                idempotency_cache->complete(key, {status, res.body, res.get_header_value("Content-Type")});
+            }
+        };
+    }
+    
     void setup_cors(Response& res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-        res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
+        res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization, Idempotency-Key");
     }
     
     void log_request(const Request& req, const std::string& action, bool include_body = false) {
@@ -138,183 +348,6 @@ private:
         return content;
     }
 
-    json call_signature_api(const std::string& endpoint, const std::string& method, 
-                            const UploadFormDataItems& items = {}, 
-                            const json& json_body = json()) {
-        if (signature_provider == "boldsign") {
-            return call_boldsign_api(endpoint, method, items, json_body);
-        } else {
-            return call_dropbox_sign_api(endpoint, method, items, json_body);
-        }
-    }
-    
-    json call_boldsign_api(const std::string& endpoint, const std::string& method,
-                          const UploadFormDataItems& items = {},
-                          const json& json_body = json()) {
-        // In demo mode, return mock responses
-        if (is_demo_mode) {
-            if (endpoint == "/v1/document/send") {
-                return {
-                    {"documentId", "demo_doc_" + generate_session_id()}
-                };
-            } else if (endpoint.find("/v1/document/getEmbeddedSignLink") == 0) {
-                return {
-                    {"signLink", {
-                        {"signUrl", "data:text/html;base64," + base64_encode(
-                            "<html><body style='font-family:Arial;text-align:center;padding:50px;'>"
-                            "<h1>Demo Signing Interface</h1>"
-                            "<p>In a real implementation, this would be the BoldSign embedded signing interface.</p>"
-                            "<p>The document would be pre-filled with your information.</p>"
-                            "<button onclick='window.parent.postMessage(\"signing_complete\", \"*\")' "
-                            "style='padding:10px 20px;font-size:16px;background:#3498db;color:white;border:none;border-radius:5px;cursor:pointer;'>"
-                            "Complete Signing (Demo)</button>"
-                            "</body></html>"
-                        )}
-                    }}
-                };
-            } else if (endpoint.find("/v1/document/properties") == 0) {
-                return {
-                    {"status", "Completed"}
-                };
-            }
-        }
-        
-        // Real BoldSign API call
-        httplib::SSLClient cli("api.boldsign.com");
-        
-        Headers headers;
-        headers.emplace("X-API-KEY", api_key);
-        Result res;
-        
-        if (method == "POST" && !items.empty()) {
-            res = cli.Post(endpoint.c_str(), headers, items);
-        } else if (method == "POST" && !json_body.empty()) {
-            headers.emplace("Content-Type", "application/json");
-            res = cli.Post(endpoint.c_str(), headers, json_body.dump(), "application/json");
-        } else if (method == "GET") {
-            res = cli.Get(endpoint.c_str(), headers);
-        }
-        
-        if (res && res->status == 200) {
-            return json::parse(res->body);
-        } else if (res && res->status == 201) {
-            return json::parse(res->body);
-        } else if (res) {
-            std::string error_msg = "API call failed: Status " + std::to_string(res->status);
-            if (!res->body.empty()) {
-                error_msg += " - " + res->body;
-            }
-            throw std::runtime_error(error_msg);
-        } else {
-            throw std::runtime_error("API call failed: Network error");
-        }
-    }
-    
-    json call_dropbox_sign_api(const std::string& endpoint, const std::string& method, 
-                              const UploadFormDataItems& items = {}, 
-                              const json& json_body = json()) {
-        // In demo mode, return mock responses
-        if (is_demo_mode) {
-            if (endpoint == "/v3/signature_request/create_embedded") {
-                return {
-                    {"signature_request", {
-                        {"signature_request_id", "demo_request_" + generate_session_id()},
-                        {"signatures", {{
-                            {"signature_id", "demo_sig_" + generate_session_id()}
-                        }}}
-                    }}
-                };
-            } else if (endpoint.find("/v3/embedded/sign_url/") == 0) {
-                // Return a demo signing URL that shows a message
-                return {
-                    {"embedded", {
-                        {"sign_url", "data:text/html;base64," + base64_encode(
-                            "<html><body style='font-family:Arial;text-align:center;padding:50px;'>"
-                            "<h1>Demo Signing Interface</h1>"
-                            "<p>In a real implementation, this would be the Dropbox Sign embedded signing interface.</p>"
-                            "<p>The document would be pre-filled with your information.</p>"
-                            "<button onclick='window.parent.postMessage(\"signing_complete\", \"*\")' "
-                            "style='padding:10px 20px;font-size:16px;background:#3498db;color:white;border:none;border-radius:5px;cursor:pointer;'>"
-                            "Complete Signing (Demo)</button>"
-                            "</body></html>"
-                        )}
-                    }}
-                };
-            } else if (endpoint.find("/v3/signature_request/") == 0) {
-                // Check if enough time has passed to simulate signing
-                return {
-                    {"signature_request", {
-                        {"is_complete", true}  // For demo, always return complete
-                    }}
-                };
-            }
-        }
-        
-        // Real API call
-        httplib::SSLClient cli("api.hellosign.com");
-        cli.set_basic_auth(api_key.c_str(), "");
-        
-        Headers headers;
-        Result res;
-        
-        if (method == "POST" && !items.empty()) {
-            res = cli.Post(endpoint.c_str(), headers, items);
-        } else if (method == "POST" && !json_body.empty()) {
-            headers.emplace("Content-Type", "application/json");
-            res = cli.Post(endpoint.c_str(), headers, json_body.dump(), "application/json");
-        } else if (method == "GET") {
-            res = cli.Get(endpoint.c_str(), headers);
-        }
-        
-        if (res && res->status == 200) {
-            return json::parse(res->body);
-        } else if (res && res->status == 201) {
-            return json::parse(res->body);
-        } else {
-            std::string error_msg = "API call failed: ";
-            if (res) {
-                error_msg += "Status " + std::to_string(res->status) + " - " + res->body;
-            } else {
-                error_msg += "Network error";
-            }
-            throw std::runtime_error(error_msg);
-        }
-    }
-
-    std::string get_file_binary(const std::string& request_id) {
-        if (signature_provider == "boldsign") {
-            // BoldSign download endpoint
-            httplib::SSLClient cli("api.boldsign.com");
-            
-            Headers headers;
-            headers.emplace("X-API-KEY", api_key);
-            
-            std::string endpoint = "/v1/document/download?documentId=" + request_id;
-            auto res = cli.Get(endpoint.c_str(), headers);
-            
-            if (res && res->status == 200) {
-                return res->body;
-            } else if (res) {
-                throw std::runtime_error("Failed to download file: Status " + std::to_string(res->status));
-            } else {
-                throw std::runtime_error("Failed to download file: Network error");
-            }
-        } else {
-            // Dropbox Sign download
-            httplib::SSLClient cli("api.hellosign.com");
-            cli.set_basic_auth(api_key.c_str(), "");
-            
-            std::string endpoint = "/v3/signature_request/files/" + request_id + "?file_type=pdf";
-            auto res = cli.Get(endpoint.c_str());
-            
-            if (res && res->status == 200) {
-                return res->body;
-            } else {
-                throw std::runtime_error("Failed to download file");
-            }
-        }
-    }
-
     bool is_valid_api_key(const std::string& key) {
         // Basic validation: not empty, not the example key, reasonable length
         if (key.empty() || key == "your_api_key_here" || key.length() < 20) {
@@ -332,81 +365,19 @@ private:
         return key.substr(0, 4) + "..." + key.substr(key.length() - 4);
     }
     
-    std::string base64_encode(const std::string& input) {
-        static const char* base64_chars = 
-            "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-            "abcdefghijklmnopqrstuvwxyz"
-            "0123456789+/";
-        
-        std::string output;
-        int i = 0;
-        unsigned char char_array_3[3];
-        unsigned char char_array_4[4];
-        int in_len = input.size();
-        const unsigned char* bytes_to_encode = reinterpret_cast<const unsigned char*>(input.c_str());
-        
-        while (in_len--) {
-            char_array_3[i++] = *(bytes_to_encode++);
-            if (i == 3) {
-                char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-                char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-                char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-                char_array_4[3] = char_array_3[2] & 0x3f;
-                
-                for(i = 0; i < 4; i++)
-                    output += base64_chars[char_array_4[i]];
-                i = 0;
-            }
-        }
-        
-        if (i) {
-            for(int j = i; j < 3; j++)
-                char_array_3[j] = '\0';
-            
-            char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-            char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-            char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-            
-            for (int j = 0; j < i + 1; j++)
-                output += base64_chars[char_array_4[j]];
-            
-            while((i++ < 3))
-                output += '=';
-        }
-        
-        return output;
-    }
-
-public:
-    DocumentSigningServer() {
-        // Load .env file if it exists
-        load_env_file();
-        
-        // Determine signature provider
-        const char* env_provider = std::getenv("SIGNATURE_PROVIDER");
-        signature_provider = env_provider ? env_provider : "dropbox";
-        
-        // Load API key based on provider
-        const char* env_api_key = nullptr;
-        if (signature_provider == "boldsign") {
-            env_api_key = std::getenv("BOLDSIGN_API_KEY");
-            if (!env_api_key) {
-                throw std::runtime_error(
-                    "BOLDSIGN_API_KEY not found. Please set it in .env file or environment variable.\n"
-                    "See .env.example for template."
-                );
-            }
-        } else {
-            env_api_key = std::getenv("DROPBOX_SIGN_API_KEY");
-            if (!env_api_key) {
-                throw std::runtime_error(
-                    "DROPBOX_SIGN_API_KEY not found. Please set it in .env file or environment variable.\n"
-                    "See .env.example for template."
-                );
-            }
+    // Reads a provider's API key (and client ID) from the environment and
+    // adds it to the router
+    template <typename P>
+    void enable_provider() {
+        const char* env_api_key = std::getenv(P::api_key_env);
+        if (!env_api_key) {
+            throw std::runtime_error(
+                std::string(P::api_key_env) + " not found. Please set it in .env file or environment variable.\n"
+                "See .env.example for template."
+            );
         }
         
-        api_key = env_api_key;
+        std::string api_key = env_api_key;
         
         // Validate API key
         if (!is_valid_api_key(api_key)) {
@@ -425,33 +396,459 @@ public:
             throw std::runtime_error(error_msg);
         }
         
-        // Load client ID for Dropbox Sign embedded signing
-        if (signature_provider == "dropbox") {
-            const char* env_client_id = std::getenv("DROPBOX_SIGN_CLIENT_ID");
+        // Load client ID for embedded signing (Dropbox Sign)
+        std::string client_id;
+        if constexpr (P::client_id_env != nullptr) {
+            const char* env_client_id = std::getenv(P::client_id_env);
             if (env_client_id) {
                 client_id = env_client_id;
                 std::cout << "Client ID loaded for embedded signing" << std::endl;
             } else {
-                std::cout << "Warning: DROPBOX_SIGN_CLIENT_ID not found. Embedded signing may not work properly." << std::endl;
+                std::cout << "Warning: " << P::client_id_env
+                          << " not found. Embedded signing may not work properly." << std::endl;
                 client_id = api_key;
             }
         }
         
         // Check if we're in demo mode
-        is_demo_mode = (api_key.find("demo") != std::string::npos || 
-                       api_key.find("test") != std::string::npos);
+        bool is_demo_mode = (api_key.find("demo") != std::string::npos || 
+                             api_key.find("test") != std::string::npos);
         
         if (is_demo_mode) {
-            std::cout << "Running in DEMO mode - API calls will be simulated" << std::endl;
+            std::cout << "Running " << P::name << " in DEMO mode - API calls will be simulated" << std::endl;
         }
         
-        std::cout << "Using " << signature_provider << " as signature provider" << std::endl;
+        // A base URL points the provider at another server, e.g. the local mock
+        ProviderOptions options = provider_options;
+        if (const char* env_base_url = std::getenv(P::base_url_env)) options.base_url = env_base_url;
+        
+        providers->enable(std::make_unique<P>(api_key, client_id, is_demo_mode, options));
+        std::cout << "Using " << P::name << " as signature provider";
+        if (!options.base_url.empty()) std::cout << " at " << options.base_url;
+        std::cout << std::endl;
         std::cout << "API Key loaded: " << mask_api_key(api_key) << std::endl;
     }
+    
+    void enable_provider_by_name(const std::string& name) {
+        Providers::each_type([&](auto tag) {
+            using P = typename decltype(tag)::type;
+            if (name == P::name) enable_provider<P>();
+        });
+    }
+    
 
+public:
+    ~DocumentSigningServer() {
+        stop_batches();
+        if (mapped_expiry_thread.joinable()) mapped_expiry_thread.join();
+    }
+    
+    DocumentSigningServer() {
+        // Handlers wait on provider I/O synchronously, so the thread count is
+        // the number of provider calls the API can have in flight; blocked
+        // threads cost little, hence well above the core count. Each thread
+        // may keep an idle keep-alive connection per provider.
+        if (const char* env_threads = std::getenv("SERVER_THREADS")) {
+            server_threads = std::max<size_t>(1, std::strtoull(env_threads, nullptr, 10));
+        }
+        if (const char* env_queued = std::getenv("SERVER_MAX_QUEUED_REQUESTS")) {
+            server_max_queued = std::strtoull(env_queued, nullptr, 10);
+        }
+        provider_options.max_idle_connections = server_threads;
+        if (const char* env_ca = std::getenv("PROVIDER_CA_CERT_FILE")) provider_options.ca_cert_file = env_ca;
+        if (const char* env_idle = std::getenv("PROVIDER_MAX_IDLE_CONNECTIONS")) {
+            provider_options.max_idle_connections = std::strtoull(env_idle, nullptr, 10);
+        }
+        
+        // Signature providers: SIGNATURE_PROVIDERS lists every provider to
+        // route between (e.g. "dropbox,boldsign"); SIGNATURE_PROVIDER is the
+        // default, which also holds sessions created before routing existed
+        const char* env_provider = std::getenv("SIGNATURE_PROVIDER");
+        std::string default_name = env_provider ? env_provider : "dropbox";
+        if (default_name != "boldsign") default_name = "dropbox";
+        const char* env_providers = std::getenv("SIGNATURE_PROVIDERS");
+        std::string names = env_providers ? env_providers : default_name;
+        
+        std::chrono::milliseconds probe_interval = std::chrono::seconds(30);
+        if (const char* env_probe = std::getenv("PROVIDER_PROBE_INTERVAL")) {
+            int64_t seconds = parse_duration_seconds(env_probe);
+            if (seconds < 0) {
+                throw std::runtime_error(std::string("Invalid PROVIDER_PROBE_INTERVAL value: ") + env_probe);
+            }
+            probe_interval = std::chrono::seconds(seconds);
+        }
+        providers = std::make_unique<Providers>(probe_interval);
+        
+        // Provider call limits: socket timeouts, and per endpoint a circuit
+        // breaker (PROVIDER_BREAKER_FAILURES in a row open it for
+        // PROVIDER_BREAKER_OPEN) and an adaptive concurrency limit that backs
+        // off when calls get slower than PROVIDER_LATENCY_TARGET_MS
+        auto read_seconds = [](const char* var, std::chrono::seconds& out) {
+            if (const char* env_value = std::getenv(var)) {
+                int64_t seconds = parse_duration_seconds(env_value);
+                if (seconds <= 0) throw std::runtime_error(std::string("Invalid ") + var + " value: " + env_value);
+                out = std::chrono::seconds(seconds);
+            }
+        };
+        read_seconds("PROVIDER_CONNECT_TIMEOUT", provider_options.connect_timeout);
+        read_seconds("PROVIDER_READ_TIMEOUT", provider_options.read_timeout);
+        std::chrono::seconds breaker_open = std::chrono::duration_cast<std::chrono::seconds>(provider_options.guard.open_duration);
+        read_seconds("PROVIDER_BREAKER_OPEN", breaker_open);
+        provider_options.guard.open_duration = breaker_open;
+        if (const char* env_failures = std::getenv("PROVIDER_BREAKER_FAILURES")) {
+            provider_options.guard.failure_threshold = std::max(1, std::atoi(env_failures));
+        }
+        if (const char* env_max = std::getenv("PROVIDER_CONCURRENCY_MAX")) {
+            provider_options.guard.max_limit = std::max(1, std::atoi(env_max));
+            provider_options.guard.initial_limit = std::min(provider_options.guard.initial_limit, provider_options.guard.max_limit);
+        }
+        if (const char* env_target = std::getenv("PROVIDER_LATENCY_TARGET_MS")) {
+            provider_options.guard.latency_target = std::chrono::milliseconds(std::max(1, std::atoi(env_target)));
+        }
+        
+        // Retries of idempotent provider calls (status, sign URL, download):
+        // PROVIDER_RETRY_ATTEMPTS per call in total, and retries overall at most
+        // PROVIDER_RETRY_BUDGET (a fraction) of first attempts. REQUEST_TIMEOUT
+        // bounds each request's provider work, retries included.
+        if (const char* env_attempts = std::getenv("PROVIDER_RETRY_ATTEMPTS")) {
+            provider_options.retry_attempts = std::max(1, std::atoi(env_attempts));
+        }
+        if (const char* env_budget = std::getenv("PROVIDER_RETRY_BUDGET")) {
+            provider_options.retry_budget = std::make_shared<RetryBudget>(std::max(0.0, std::atof(env_budget)));
+        }
+        
+        // Hedged signing-URL requests: a second copy goes out once the first
+        // is slower than PROVIDER_HEDGE_PERCENTILE of recent calls (0 = off),
+        // for at most PROVIDER_HEDGE_BUDGET (a fraction) of calls
+        if (const char* env_percentile = std::getenv("PROVIDER_HEDGE_PERCENTILE")) {
+            provider_options.hedge_percentile = std::min(100.0, std::max(0.0, std::atof(env_percentile)));
+        }
+        if (const char* env_hedge_budget = std::getenv("PROVIDER_HEDGE_BUDGET")) {
+            provider_options.hedge_ratio = std::max(0.0, std::atof(env_hedge_budget));
+        }
+        std::chrono::seconds request_seconds = std::chrono::duration_cast<std::chrono::seconds>(request_timeout);
+        read_seconds("REQUEST_TIMEOUT", request_seconds);
+        request_timeout = request_seconds;
+        
+        std::stringstream name_list(names);
+        std::string name;
+        while (std::getline(name_list, name, ',')) {
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t") + 1);
+            if (name.empty()) continue;
+            if (Providers::id_of(name) == 0) {
+                throw std::runtime_error("Unknown signature provider in SIGNATURE_PROVIDERS: " + name);
+            }
+            enable_provider_by_name(name);
+        }
+        uint8_t default_id = Providers::id_of(default_name);
+        if (!providers->enabled(default_id)) enable_provider_by_name(default_name);
+        providers->set_default(default_id);
+        
+        // Signed document cache size (MB)
+        size_t document_cache_mb = 256;
+        if (const char* env_cache = std::getenv("DOCUMENT_CACHE_MAX_MB")) {
+            document_cache_mb = std::strtoul(env_cache, nullptr, 10);
+        }
+        document_cache = std::make_unique<DocumentCache>(document_cache_mb * 1024 * 1024);
+        // ETag and Last-Modified of signed documents, kept next to the WAL
+        const char* env_validators_dir = std::getenv("SESSION_WAL_DIR");
+        document_validators = std::make_unique<DocumentValidators>(
+            env_validators_dir ? std::string(env_validators_dir) + "/documents.log" : "");
+        
+        // Bulk creation: provider calls in flight per batch, threads for all
+        // batches together, and items per batch
+        if (const char* env_concurrency = std::getenv("BATCH_CONCURRENCY")) {
+            batch_concurrency = std::max<size_t>(1, std::strtoull(env_concurrency, nullptr, 10));
+        }
+        if (const char* env_workers = std::getenv("BATCH_WORKERS")) {
+            batch_workers = std::max<size_t>(1, std::strtoull(env_workers, nullptr, 10));
+        }
+        if (const char* env_items = std::getenv("BATCH_MAX_ITEMS")) {
+            batch_max_items = std::strtoull(env_items, nullptr, 10);
+        }
+        
+        // Provider templates: the PDF is registered once and sessions reference
+        // it (PROVIDER_TEMPLATES=off uploads it with every session instead).
+        // Template IDs persist in TEMPLATE_CACHE_FILE, or next to the WAL.
+        const char* env_templates = std::getenv("PROVIDER_TEMPLATES");
+        std::string templates_mode = env_templates ? env_templates : "on";
+        if (templates_mode != "off" && templates_mode != "0" && templates_mode != "false") {
+            std::string cache_file;
+            if (const char* env_cache = std::getenv("TEMPLATE_CACHE_FILE")) {
+                cache_file = env_cache;
+            } else if (const char* env_wal_dir = std::getenv("SESSION_WAL_DIR")) {
+                cache_file = std::string(env_wal_dir) + "/templates.json";
+            }
+            template_registry = std::make_unique<TemplateRegistry>(cache_file);
+        }
+        
+        // Documents per GET /api/documents:export archive
+        if (const char* env_export = std::getenv("EXPORT_MAX_DOCUMENTS")) {
+            export_max_documents = std::strtoull(env_export, nullptr, 10);
+        }
+        
+        // Pending statuses confirmed within STATUS_MAX_AGE are served locally;
+        // STATUS_BATCH_DEADLINE_MS bounds one POST /api/sessions/status:batch
+        int64_t status_max_age = 5;
+        if (const char* env_age = std::getenv("STATUS_MAX_AGE")) {
+            status_max_age = parse_duration_seconds(env_age);
+            if (status_max_age < 0) {
+                throw std::runtime_error(std::string("Invalid STATUS_MAX_AGE value: ") + env_age);
+            }
+        }
+        status_freshness = std::make_unique<StatusFreshness>(std::chrono::seconds(status_max_age));
+        if (const char* env_deadline = std::getenv("STATUS_BATCH_DEADLINE_MS")) {
+            status_batch_deadline = std::chrono::milliseconds(std::strtoull(env_deadline, nullptr, 10));
+        }
+        
+        // Signing URLs are fetched right after a session is created, cached
+        // until near the provider's expiry and refreshed SIGN_URL_REFRESH_AHEAD
+        // before it (SIGN_URL_CACHE=off fetches one per request instead)
+        const char* env_sign_url_cache = std::getenv("SIGN_URL_CACHE");
+        if (!env_sign_url_cache || (std::string(env_sign_url_cache) != "off" && std::string(env_sign_url_cache) != "0")) {
+            int64_t refresh_ahead = 300;
+            if (const char* env_ahead = std::getenv("SIGN_URL_REFRESH_AHEAD")) {
+                refresh_ahead = parse_duration_seconds(env_ahead);
+                if (refresh_ahead < 0) {
+                    throw std::runtime_error(std::string("Invalid SIGN_URL_REFRESH_AHEAD value: ") + env_ahead);
+                }
+            }
+            sign_url_cache = std::make_unique<SignUrlCache>([this](const SessionId& id) { refresh_sign_url(id); },
+                                                            std::chrono::seconds(refresh_ahead));
+        }
+        
+        // Idempotency-Key results for POST /api/sessions
+        int64_t idempotency_ttl = 24 * 3600;
+        if (const char* env_ttl = std::getenv("IDEMPOTENCY_TTL")) {
+            idempotency_ttl = parse_duration_seconds(env_ttl);
+            if (idempotency_ttl < 0) {
+                throw std::runtime_error(std::string("Invalid IDEMPOTENCY_TTL value: ") + env_ttl);
+            }
+        }
+        size_t idempotency_max_keys = 10000;
+        if (const char* env_keys = std::getenv("IDEMPOTENCY_MAX_KEYS")) {
+            idempotency_max_keys = std::strtoull(env_keys, nullptr, 10);
+        }
+        idempotency_cache = std::make_unique<IdempotencyCache>(idempotency_max_keys,
+                                                               std::chrono::seconds(idempotency_ttl));
+        
+        // Session lifetimes (SESSION_TTL_PENDING, SESSION_TTL_SIGNED, ...)
+        session_expiry = std::make_unique<SessionExpiry>([this](const std::vector<SessionId>& expired) {
+            session_store.erase(expired);
+            status_freshness->forget(expired);
+            if (sign_url_cache) sign_url_cache->forget(expired);
+            std::vector<std::string> keys;
+            for (const auto& id : expired) {
+                document_cache->erase(id.str());
+                keys.push_back(id.str());
+            }
+            document_validators->forget(keys);
+        });
+        std::cout << "Session TTLs: pending " << session_expiry->ttl_for(SessionStatus::Pending) << "s, signed "
+                  << session_expiry->ttl_for(SessionStatus::Signed) << "s" << std::endl;
+        
+        // Optional persistence: SESSION_WAL_DIR enables the write-ahead log
+        if (const char* env_wal_dir = std::getenv("SESSION_WAL_DIR")) {
+            restore_sessions(env_wal_dir);
+        }
+        
+        // Response compression: API_COMPRESSION_* applies to the JSON routes,
+        // LIST_COMPRESSION_* to the (potentially large) session listing
+        api_compression = CompressionPolicy::from_env("API_COMPRESSION", {1024, 5});
+        listing_compression = CompressionPolicy::from_env("LIST_COMPRESSION", {1024, 7});
+    }
+
+    // The session's document: the cached copy when we have one, otherwise a
+    // fresh download. Only completed documents are cached since they can no
+    // longer change; their validators are remembered, so Last-Modified is the
+    // time the signed document was first seen.
+    std::shared_ptr<const CachedDocument> load_document(const SigningSession& session) {
+        std::string key = session.id.str();
+        auto doc = document_cache->get(key);
+        if (!doc) {
+            auto fresh = DocumentCache::make_document(providers->call(session.provider, ProviderCall::Download,
+                [&](auto& provider) { return provider.download(session); }));
+            if (session.status == SessionStatus::Signed) {
+                fresh->last_modified = document_validators->remember(key, fresh->etag, fresh->last_modified);
+                document_cache->put(key, fresh);
+            }
+            doc = fresh;
+        }
+        return doc;
+    }
+    
+    // The session's signing URL: the cached one when it is still good (or
+    // about to arrive from a prefetch), otherwise a fresh one from the provider
+    std::string signing_url(const SigningSession& session) {
+        if (sign_url_cache) {
+            auto wait_until = std::min(RequestDeadline::get(), RequestDeadline::Clock::now() + request_timeout);
+            if (auto cached = sign_url_cache->get(session.id, wait_until)) return *cached;
+        }
+        SignUrl sign_url = providers->call(session.provider, ProviderCall::SignUrl, [&](auto& provider) {
+            return provider.sign_url(session);
+        });
+        if (sign_url_cache) sign_url_cache->put(session.id, sign_url.url, sign_url.expires_at);
+        return sign_url.url;
+    }
+    
+    // Background fetch for the signing URL cache; signed and vanished
+    // sessions need no URL any more
+    void refresh_sign_url(const SessionId& id) {
+        auto session = session_store.find(id);
+        if (!session || session->status != SessionStatus::Pending) {
+            sign_url_cache->forget({id});
+            return;
+        }
+        RequestDeadline::Scope scope(RequestDeadline::Clock::now() + request_timeout);
+        CallPriorityScope background(CallPriority::Background);
+        SignUrl sign_url = providers->call(session->provider, ProviderCall::SignUrl, [&](auto& provider) {
+            return provider.sign_url(*session);
+        });
+        sign_url_cache->put(id, sign_url.url, sign_url.expires_at);
+    }
+    
+    // Whether current_status() can answer without calling the provider
+    bool status_is_fresh(const SigningSession& session) {
+        return session.status == SessionStatus::Signed || status_freshness->is_fresh(session.id);
+    }
+    
+    // A session's status: signed is terminal and, with `reuse_recent`, a
+    // recently confirmed pending status is reused; otherwise the provider is
+    // asked and the store updated
+    SessionStatus current_status(const SigningSession& session, bool reuse_recent = true) {
+        if (session.status == SessionStatus::Signed || (reuse_recent && status_is_fresh(session))) {
+            return session.status;
+        }
+        
+        SessionStatus status = providers->call(session.provider, ProviderCall::Status, [&](auto& provider) {
+            return provider.fetch_status(session);
+        });
+        if (status != session.status && session_store.update_status(session.id, status)) {
+            session_expiry->schedule(session.id, status);
+            if (status == SessionStatus::Signed && sign_url_cache) sign_url_cache->forget({session.id});
+        }
+        if (status == SessionStatus::Pending) status_freshness->mark_checked(session.id);
+        return status;
+    }
+    
+    // Checks one signer object; returns an error message, or an empty string
+    // with name/email/phone filled in
+    std::string validate_signer(const json& signer, std::string& name, std::string& email, std::string& phone) {
+        if (!signer.is_object() || !signer.contains("name") || !signer.contains("email") || !signer.contains("phone")) {
+            return "Missing required fields";
+        }
+        if (!signer["name"].is_string() || !signer["email"].is_string() || !signer["phone"].is_string()) {
+            return "Fields must be strings";
+        }
+        
+        name = signer["name"];
+        email = signer["email"];
+        phone = signer["phone"];
+        
+        if (name.empty() || email.empty() || phone.empty()) {
+            return "Fields cannot be empty";
+        }
+        if (name.size() > 256 || email.size() > 256 || phone.size() > 64) {
+            return "Field too long";
+        }
+        if (!validate_email(email)) {
+            return "Invalid email format";
+        }
+        return "";
+    }
+    
+    // Creates the provider document for one signer. With templates enabled
+    // the PDF is uploaded once per distinct document; if registering fails,
+    // or the provider has dropped the template, this request falls back to
+    // uploading the PDF itself.
+    template <typename P>
+    ProviderDocument send_document(P& provider, const std::string& name, const std::string& email,
+                                   const std::string& phone, const std::string& pdf_content) {
+        if (template_registry) {
+            std::string key = std::string(P::name) + ":" + sha256_hex(pdf_content);
+            std::string template_id;
+            try {
+                template_id = template_registry->get_or_register(key, [&] { return provider.register_template(pdf_content); });
+            } catch (const std::exception& e) {
+                std::cerr << "Template registration failed, uploading instead: " << e.what() << std::endl;
+            }
+            if (!template_id.empty()) {
+                try {
+                    return provider.send_with_template(template_id, name, email, phone);
+                } catch (const ProviderError& e) {
+                    if (e.status != 404) throw;
+                    std::cerr << "Template " << template_id << " is gone, uploading instead" << std::endl;
+                    template_registry->invalidate(key);
+                }
+            }
+        }
+        return provider.send_with_upload(name, email, phone, pdf_content);
+    }
+    
+    // Creates the provider document and the local session for one signer.
+    // Providers are tried best first (see ProviderRouter); a provider error
+    // fails over to the next one, and the session is pinned to whichever
+    // provider took the document. A request a provider rejects outright (4xx)
+    // fails without trying the others.
+    SigningSession create_session(const std::string& name, const std::string& email,
+                                  const std::string& phone, const std::string& pdf_content) {
+        std::optional<ProviderDocument> document;
+        uint8_t provider_id = 0;
+        std::exception_ptr last_error;
+        for (uint8_t id : providers->ranked()) {
+            try {
+                document = providers->call(id, ProviderCall::Create, [&](auto& provider) {
+                    return send_document(provider, name, email, phone, pdf_content);
+                });
+                provider_id = id;
+                break;
+            } catch (const ProviderError& e) {
+                if (e.definitive()) throw;  // the request itself was refused; no provider would take it
+                std::cerr << "Creating document via " << Providers::name_of(id) << " failed: " << e.what() << std::endl;
+                last_error = std::current_exception();
+            } catch (const std::exception& e) {
+                std::cerr << "Creating document via " << Providers::name_of(id) << " failed: " << e.what() << std::endl;
+                last_error = std::current_exception();
+            }
+        }
+        if (!document) {
+            if (last_error) std::rethrow_exception(last_error);
+            throw std::runtime_error("No signature provider available");
+        }
+        
+        // Create session
+        SigningSession session;
+        session.set_fields(document->signature_request_id, document->signature_id, name, email, phone);
+        session.status = SessionStatus::Pending;
+        session.provider = provider_id;
+        session.created_at = SessionClock::now();
+        
+        // Never overwrite a live session: draw again on an ID collision
+        do {
+            session.id = SessionId::generate();
+        } while (!session_store.insert(session));
+        session_expiry->schedule(session.id, session.status);
+        // Start on the signing URL first so it overlaps the log flush. Batch
+        // creates run at background priority and nobody opens their pages
+        // right away, so they fetch URLs on demand.
+        if (sign_url_cache && CallPriorityScope::get() != CallPriority::Background) {
+            sign_url_cache->prefetch(session.id);
+        }
+        // Don't hand out an ID that a crash could forget (group commit)
+        if (session_wal) session_wal->sync();
+        return session;
+    }
+    
     void setup_routes() {
-        // Serve static files
-        server.set_mount_point("/", "./public");
+        // Serve static files from memory (precompressed, reloaded on change)
+        static_assets = std::make_unique<StaticAssetCache>("./public");
+        static_assets->start_watching();
+        server.Get(R"(/(?!api/).*)", [this](const Request& req, Response& res) {
+            if (!static_assets->serve(req, res)) {
+                res.status = 404;
+            }
+        });
         
         // Handle CORS preflight
         server.Options("/api/.*", [this](const Request& req, Response& res) {
@@ -459,35 +856,22 @@ public:
             res.status = 204;
         });
         
-        // Create signing session
-        server.Post("/api/sessions", [this](const Request& req, Response& res) {
+        // Create signing session. With "include_sign_url": true the response
+        // also carries the signing URL (fetched while the session is being
+        // saved), saving the client a round trip; if only that part fails the
+        // session is still returned, with "sign_url_error".
+        server.Post("/api/sessions", compressed(api_compression, idempotent(deadline_bound([this](const Request& req, Response& res) {
             setup_cors(res);
             log_request(req, "Create signing session", true);
             
             try {
                 auto body = json::parse(req.body);
                 
-                // Validate required fields
-                if (!body.contains("name") || !body.contains("email") || !body.contains("phone")) {
+                std::string name, email, phone;
+                std::string error = validate_signer(body, name, email, phone);
+                if (!error.empty()) {
                     res.status = 400;
-                    res.set_content("{\"error\":\"Missing required fields\"}", "application/json");
-                    return;
-                }
-                
-                std::string name = body["name"];
-                std::string email = body["email"];
-                std::string phone = body["phone"];
-                
-                // Validate inputs
-                if (name.empty() || email.empty() || phone.empty()) {
-                    res.status = 400;
-                    res.set_content("{\"error\":\"Fields cannot be empty\"}", "application/json");
-                    return;
-                }
-                
-                if (!validate_email(email)) {
-                    res.status = 400;
-                    res.set_content("{\"error\":\"Invalid email format\"}", "application/json");
+                    res.set_content(json{{"error", error}}.dump(), "application/json");
                     return;
                 }
                 
@@ -501,321 +885,609 @@ public:
                     return;
                 }
                 
-                std::string signature_request_id;
-                std::string signature_id;
-                
-                if (signature_provider == "boldsign") {
-                    // Create document for BoldSign
-                    json request_body = {
-                        {"title", "Document for Signing"},
-                        {"message", "Please sign this document"},
-                        {"signers", {{
-                            {"name", name},
-                            {"emailAddress", email},
-                            {"signerOrder", 1},
-                            {"signerType", "Signer"},
-                            {"formFields", {
-                                {
-                                    {"fieldType", "Textbox"},
-                                    {"pageNumber", 1},
-                                    {"bounds", {{"x", 100}, {"y", 200}, {"width", 200}, {"height", 20}}},
-                                    {"isRequired", true},
-                                    {"id", "name_field"},
-                                    {"value", name}
-                                },
-                                {
-                                    {"fieldType", "Textbox"},
-                                    {"pageNumber", 1},
-                                    {"bounds", {{"x", 100}, {"y", 250}, {"width", 200}, {"height", 20}}},
-                                    {"isRequired", true},
-                                    {"id", "email_field"},
-                                    {"value", email}
-                                },
-                                {
-                                    {"fieldType", "Textbox"},
-                                    {"pageNumber", 1},
-                                    {"bounds", {{"x", 100}, {"y", 300}, {"width", 200}, {"height", 20}}},
-                                    {"isRequired", true},
-                                    {"id", "phone_field"},
-                                    {"value", phone}
-                                },
-                                {
-                                    {"fieldType", "Signature"},
-                                    {"pageNumber", 1},
-                                    {"bounds", {{"x", 100}, {"y", 400}, {"width", 200}, {"height", 60}}},
-                                    {"isRequired", true},
-                                    {"id", "signature_field"}
-                                }
-                            }}
-                        }}},
-                        {"disableEmails", true},  // For embedded signing
-                        {"files", json::array({
-                            "data:application/pdf;base64," + base64_encode(pdf_content)
-                        })}
-                    };
-                    
-                    json api_response = call_signature_api("/v1/document/send", "POST", {}, request_body);
-                    
-                    // Log the response for debugging
-                    std::cout << "BoldSign create response: " << api_response.dump() << std::endl;
-                    
-                    // Extract document ID from response
-                    if (api_response.contains("documentId")) {
-                        signature_request_id = api_response["documentId"];
-                    } else {
-                        throw std::runtime_error("No documentId in BoldSign response");
-                    }
-                    
-                    signature_id = signature_request_id; // BoldSign uses documentId for both
-                } else {
-                    // Create multipart form data for Dropbox Sign API
-                    UploadFormDataItems items = {
-                        {"test_mode", "1", "", ""},
-                        {"client_id", client_id, "", ""},
-                        {"subject", "Document for Signing", "", ""},
-                        {"message", "Please sign this document", "", ""},
-                        {"signers[0][email_address]", email, "", ""},
-                        {"signers[0][name]", name, "", ""},
-                        {"file[0]", pdf_content, "sample.pdf", "application/pdf"},
-                        {"form_fields_per_document", json::array({
-                            json::array({
-                                {{"api_id", "name_field"}, {"name", "Name"}, {"type", "text"}, 
-                                 {"x", 100}, {"y", 200}, {"width", 200}, {"height", 20}, 
-                                 {"required", true}, {"signer", 0}, {"page", 1}, {"value", name}},
-                                {{"api_id", "email_field"}, {"name", "Email"}, {"type", "text"}, 
-                                 {"x", 100}, {"y", 250}, {"width", 200}, {"height", 20}, 
-                                 {"required", true}, {"signer", 0}, {"page", 1}, {"value", email}},
-                                {{"api_id", "phone_field"}, {"name", "Phone"}, {"type", "text"}, 
-                                 {"x", 100}, {"y", 300}, {"width", 200}, {"height", 20}, 
-                                 {"required", true}, {"signer", 0}, {"page", 1}, {"value", phone}},
-                                {{"api_id", "signature_field"}, {"name", "Signature"}, {"type", "signature"}, 
-                                 {"x", 100}, {"y", 400}, {"width", 200}, {"height", 60}, 
-                                 {"required", true}, {"signer", 0}, {"page", 1}}
-                            })
-                        }).dump(), "", ""}
-                    };
-                    
-                    json api_response = call_signature_api("/v3/signature_request/create_embedded", "POST", items);
-                    signature_request_id = api_response["signature_request"]["signature_request_id"];
-                    signature_id = api_response["signature_request"]["signatures"][0]["signature_id"];
-                }
-                
-                // Create session
-                std::string session_id = generate_session_id();
-                SigningSession session;
-                session.id = session_id;
-                session.signature_request_id = signature_request_id;
-                session.signature_id = signature_id;
-                session.status = "pending";
-                session.signer_info = {{"name", name}, {"email", email}, {"phone", phone}};
-                session.created_at = std::chrono::system_clock::now().time_since_epoch().count();
-                
-                {
-                    std::lock_guard<std::mutex> lock(sessions_mutex);
-                    signing_sessions[session_id] = session;
-                }
+                SigningSession session = create_session(name, email, phone, pdf_content);
                 
                 json response = {
-                    {"session_id", session_id}
+                    {"session_id", session.id.str()}
                 };
+                if (body.contains("include_sign_url") && body["include_sign_url"] == true) {
+                    // One provider fetch either way: this waits for the prefetch
+                    // create_session() queued if a worker has started it, and
+                    // otherwise takes it off the queue and fetches here
+                    try {
+                        response["sign_url"] = signing_url(session);
+                    } catch (const std::exception& e) {
+                        response["sign_url_error"] = e.what();
+                    }
+                }
                 
                 res.set_content(response.dump(), "application/json");
+            } catch (const ProviderUnavailable& e) {
+                respond_unavailable(res, e);
+            } catch (const DeadlineExceeded& e) {
+                respond_deadline_exceeded(res, e);
             } catch (const std::exception& e) {
                 res.status = 500;
                 json error_response = {{"error", e.what()}};
                 res.set_content(error_response.dump(), "application/json");
             }
-        });
+        }))));
         
-        // Get signing URL
-        server.Post("/api/sessions/:id/signing-url", [this](const Request& req, Response& res) {
+        // Create many sessions at once: signers are validated in one pass, then
+        // submitted to the provider BATCH_CONCURRENCY at a time over pooled
+        // connections. One NDJSON line per signer streams back as each finishes.
+        server.Post("/api/sessions:batch", [this](const Request& req, Response& res) {
             setup_cors(res);
+            log_request(req, "Create signing sessions (batch)");
             
-            std::string session_id = req.path_params.at("id");
+            json body;
+            try {
+                body = json::parse(req.body);
+            } catch (const std::exception&) {
+                res.status = 400;
+                res.set_content("{\"error\":\"Invalid JSON\"}", "application/json");
+                return;
+            }
+            const json& signers = body.is_object() && body.contains("signers") ? body["signers"] : body;
+            if (!signers.is_array() || signers.empty()) {
+                res.status = 400;
+                res.set_content("{\"error\":\"Expected a non-empty array of signers\"}", "application/json");
+                return;
+            }
+            if (signers.size() > batch_max_items) {
+                res.status = 413;
+                res.set_content(json{{"error", "Too many signers (max " + std::to_string(batch_max_items) + ")"}}.dump(),
+                                "application/json");
+                return;
+            }
             
+            auto pdf_content = std::make_shared<std::string>();
             try {
-                SigningSession session;
-                {
-                    std::lock_guard<std::mutex> lock(sessions_mutex);
-                    auto it = signing_sessions.find(session_id);
-                    if (it == signing_sessions.end()) {
-                        res.status = 404;
-                        res.set_content("{\"error\":\"Session not found\"}", "application/json");
-                        return;
-                    }
-                    session = it->second;
+                *pdf_content = read_file_to_string("./backend/sample.pdf");
+            } catch (const std::exception& e) {
+                res.status = 500;
+                res.set_content("{\"error\":\"Sample PDF not found\"}", "application/json");
+                return;
+            }
+            
+            struct Signer {
+                size_t index;
+                std::string name, email, phone;
+            };
+            auto valid = std::make_shared<std::vector<Signer>>();
+            auto rejected = std::make_shared<std::string>();
+            for (size_t i = 0; i < signers.size(); i++) {
+                Signer signer{i, "", "", ""};
+                std::string error = validate_signer(signers[i], signer.name, signer.email, signer.phone);
+                if (error.empty()) {
+                    valid->push_back(std::move(signer));
+                } else {
+                    *rejected += json{{"index", i}, {"status", 400}, {"error", error}}.dump() + "\n";
                 }
-                
-                // Get embedded signing URL
-                std::string sign_url;
-                
-                if (signature_provider == "boldsign") {
-                    // BoldSign processes documents asynchronously, add a small delay
-                    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+            }
+            
+            auto batch = std::make_shared<std::unique_ptr<ParallelBatch<std::string>>>();
+            res.set_chunked_content_provider("application/x-ndjson",
+                [this, valid, rejected, pdf_content, batch](size_t, DataSink& sink) {
+                    if (!rejected->empty() && !sink.write(rejected->data(), rejected->size())) return false;
                     
-                    // BoldSign uses query parameters
-                    std::cout << "Getting BoldSign signing URL for document: " << session.signature_request_id << std::endl;
-                    std::cout << "Signer email: " << session.signer_info["email"].get<std::string>() << std::endl;
+                    *batch = std::make_unique<ParallelBatch<std::string>>(*batch_pool, valid->size(), batch_concurrency,
+                        [this, valid, pdf_content](size_t k) {
+                            const Signer& signer = (*valid)[k];
+                            RequestDeadline::Scope scope(RequestDeadline::Clock::now() + request_timeout);
+                            CallPriorityScope background(CallPriority::Background);
+                            try {
+                                SigningSession session = create_session(signer.name, signer.email,
+                                                                        signer.phone, *pdf_content);
+                                return json{{"index", signer.index}, {"status", 200},
+                                            {"session_id", session.id.str()}}.dump() + "\n";
+                            } catch (const ProviderUnavailable& e) {
+                                return json{{"index", signer.index}, {"status", 503}, {"error", e.what()},
+                                            {"retry_after", e.retry_after.count()}}.dump() + "\n";
+                            } catch (const DeadlineExceeded& e) {
+                                return json{{"index", signer.index}, {"status", 504},
+                                            {"error", e.what()}}.dump() + "\n";
+                            } catch (const std::exception& e) {
+                                return json{{"index", signer.index}, {"status", 502},
+                                            {"error", e.what()}}.dump() + "\n";
+                            }
+                        });
                     
-                    // URL encode the email
-                    std::string email = session.signer_info["email"].get<std::string>();
-                    std::string encoded_email;
-                    for (char c : email) {
-                        if (c == '@') {
-                            encoded_email += "%40";
-                        } else if (c == '.') {
-                            encoded_email += c;  // dots don't need encoding in query params
-                        } else {
-                            encoded_email += c;
+                    std::string line;
+                    while ((*batch)->next(line)) {
+                        if (!sink.write(line.data(), line.size())) {
+                            (*batch)->cancel();  // client went away: stop submitting
+                            return false;
                         }
                     }
-                    
-                    std::string endpoint = "/v1/document/getEmbeddedSignLink?documentId=" + 
-                                         session.signature_request_id + 
-                                         "&signerEmail=" + encoded_email;
-                    
-                    std::cout << "Full endpoint: " << endpoint << std::endl;
-                    
-                    json api_response = call_signature_api(endpoint, "GET");
-                    
-                    // Log the response to debug
-                    std::cout << "BoldSign embedded sign link response: " << api_response.dump() << std::endl;
-                    
-                    // BoldSign returns the URL directly in "signLink" field
-                    if (api_response.contains("signLink")) {
-                        if (api_response["signLink"].is_string()) {
-                            sign_url = api_response["signLink"];
-                        } else if (api_response["signLink"].is_object() && api_response["signLink"].contains("signUrl")) {
-                            sign_url = api_response["signLink"]["signUrl"];
-                        } else {
-                            throw std::runtime_error("Unexpected signLink format in BoldSign response");
-                        }
-                    } else {
-                        throw std::runtime_error("No signLink in BoldSign response: " + api_response.dump());
-                    }
-                } else {
-                    std::string endpoint = "/v3/embedded/sign_url/" + session.signature_id;
-                    json api_response = call_signature_api(endpoint, "GET");
-                    sign_url = api_response["embedded"]["sign_url"];
+                    sink.done();
+                    return true;
+                });
+        });
+        
+        // Get signing URL
+        server.Post("/api/sessions/:id/signing-url", compressed(api_compression, deadline_bound([this](const Request& req, Response& res) {
+            setup_cors(res);
+            
+            std::string session_id = req.path_params.at("id");
+            
+            try {
+                auto found = find_session(session_id);
+                if (!found) {
+                    res.status = 404;
+                    res.set_content("{\"error\":\"Session not found\"}", "application/json");
+                    return;
                 }
+                const SigningSession& session = *found;
+                
+                // Get embedded signing URL
+                std::string sign_url = signing_url(session);
                 
                 json response = {
                     {"sign_url", sign_url}
                 };
                 
                 res.set_content(response.dump(), "application/json");
+            } catch (const ProviderUnavailable& e) {
+                respond_unavailable(res, e);
+            } catch (const DeadlineExceeded& e) {
+                respond_deadline_exceeded(res, e);
             } catch (const std::exception& e) {
                 res.status = 500;
                 json error_response = {{"error", e.what()}};
                 res.set_content(error_response.dump(), "application/json");
             }
-        });
+        })));
         
-        // Get session status
-        server.Get("/api/sessions/:id/status", [this](const Request& req, Response& res) {
+        // Get session status (polled by the page, so it yields to interactive provider calls).
+        // A pending status is always confirmed with the provider here; only
+        // status:batch answers from recent checks.
+        server.Get("/api/sessions/:id/status", compressed(api_compression, deadline_bound([this](const Request& req, Response& res) {
             setup_cors(res);
+            CallPriorityScope background(CallPriority::Background);
             
             std::string session_id = req.path_params.at("id");
             
             try {
-                SigningSession session;
-                {
-                    std::lock_guard<std::mutex> lock(sessions_mutex);
-                    auto it = signing_sessions.find(session_id);
-                    if (it == signing_sessions.end()) {
-                        res.status = 404;
-                        res.set_content("{\"error\":\"Session not found\"}", "application/json");
-                        return;
-                    }
-                    session = it->second;
-                }
-                
-                // Get signature request status from API
-                std::string status;
-                
-                if (signature_provider == "boldsign") {
-                    std::string endpoint = "/v1/document/properties?documentId=" + session.signature_request_id;
-                    json api_response = call_signature_api(endpoint, "GET");
-                    
-                    std::string doc_status = api_response["status"];
-                    status = (doc_status == "Completed") ? "signed" : "pending";
-                } else {
-                    std::string endpoint = "/v3/signature_request/" + session.signature_request_id;
-                    json api_response = call_signature_api(endpoint, "GET");
-                    
-                    bool is_complete = api_response["signature_request"]["is_complete"];
-                    status = is_complete ? "signed" : "pending";
-                }
-                
-                // Update local status
-                {
-                    std::lock_guard<std::mutex> lock(sessions_mutex);
-                    signing_sessions[session_id].status = status;
+                auto found = find_session(session_id);
+                if (!found) {
+                    res.status = 404;
+                    res.set_content("{\"error\":\"Session not found\"}", "application/json");
+                    return;
                 }
+                SessionStatus status = current_status(*found, false);
                 
                 json response = {
-                    {"status", status}
+                    {"status", to_string(status)}
                 };
                 
                 res.set_content(response.dump(), "application/json");
+            } catch (const ProviderUnavailable& e) {
+                respond_unavailable(res, e);
+            } catch (const DeadlineExceeded& e) {
+                respond_deadline_exceeded(res, e);
             } catch (const std::exception& e) {
                 res.status = 500;
                 json error_response = {{"error", e.what()}};
                 res.set_content(error_response.dump(), "application/json");
             }
-        });
+        })));
+        
+        // Statuses for many sessions in one call. Fresh ones come from the store;
+        // the rest are fanned out to the provider BATCH_CONCURRENCY at a time.
+        // Whatever hasn't come back by the deadline is reported with its last
+        // known status and "fresh": false.
+        server.Post("/api/sessions/status:batch", compressed(api_compression, [this](const Request& req, Response& res) {
+            setup_cors(res);
+            log_request(req, "Get session statuses (batch)");
+            
+            json body;
+            try {
+                body = json::parse(req.body);
+            } catch (const std::exception&) {
+                res.status = 400;
+                res.set_content("{\"error\":\"Invalid JSON\"}", "application/json");
+                return;
+            }
+            const json& ids = body.is_object() && body.contains("ids") ? body["ids"] : body;
+            if (!ids.is_array() || ids.empty()) {
+                res.status = 400;
+                res.set_content("{\"error\":\"Expected a non-empty array of session IDs\"}", "application/json");
+                return;
+            }
+            if (ids.size() > batch_max_items) {
+                res.status = 413;
+                res.set_content(json{{"error", "Too many IDs (max " + std::to_string(batch_max_items) + ")"}}.dump(),
+                                "application/json");
+                return;
+            }
+            auto deadline_ms = status_batch_deadline;
+            if (body.is_object() && body.contains("deadline_ms") && body["deadline_ms"].is_number_unsigned()) {
+                deadline_ms = std::min(deadline_ms, std::chrono::milliseconds(body["deadline_ms"].get<uint64_t>()));
+            }
+            auto deadline = std::chrono::steady_clock::now() + deadline_ms;
+            
+            json results = json::array();
+            auto stale = std::make_shared<std::vector<SigningSession>>();
+            std::vector<size_t> stale_slots;
+            for (const auto& entry : ids) {
+                std::string id = entry.is_string() ? entry.get<std::string>() : "";
+                auto found = find_session(id);
+                if (!found) {
+                    results.push_back({{"id", id}, {"error", "Session not found"}});
+                    continue;
+                }
+                bool fresh = status_is_fresh(*found);
+                results.push_back({{"id", id}, {"status", to_string(found->status)}, {"fresh", fresh}});
+                if (!fresh) {
+                    stale_slots.push_back(results.size() - 1);
+                    stale->push_back(std::move(*found));
+                }
+            }
+            
+            using Refreshed = std::pair<size_t, json>;
+            ParallelBatch<Refreshed> batch(*batch_pool, stale->size(), batch_concurrency, [this, stale, deadline](size_t k) {
+                RequestDeadline::Scope scope(deadline);
+                CallPriorityScope background(CallPriority::Background);
+                try {
+                    SessionStatus status = current_status((*stale)[k]);
+                    return Refreshed{k, {{"status", to_string(status)}, {"fresh", true}}};
+                } catch (const std::exception& e) {
+                    return Refreshed{k, {{"error", e.what()}}};
+                }
+            });
+            
+            Refreshed refreshed;
+            size_t pending = stale->size();
+            while (pending > 0 && batch.next_until(refreshed, deadline) == ParallelBatch<Refreshed>::Wait::Ready) {
+                results[stale_slots[refreshed.first]].update(refreshed.second);
+                pending--;
+            }
+            
+            json response = {{"sessions", results}};
+            if (pending > 0) response["timed_out"] = pending;
+            res.set_content(response.dump(), "application/json");
+        }));
         
         // Get signed document
-        server.Get("/api/documents/:id.pdf", [this](const Request& req, Response& res) {
+        // (regex route: httplib would name a ":id.pdf" path param "id.pdf")
+        server.Get(R"(/api/documents/([^/]+)\.pdf)", deadline_bound([this](const Request& req, Response& res) {
             setup_cors(res);
             
-            std::string session_id = req.path_params.at("id");
-            session_id = session_id.substr(0, session_id.find(".pdf"));
+            std::string session_id = req.matches[1];
             
             try {
-                SigningSession session;
-                {
-                    std::lock_guard<std::mutex> lock(sessions_mutex);
-                    auto it = signing_sessions.find(session_id);
-                    if (it == signing_sessions.end()) {
-                        res.status = 404;
-                        res.set_content("{\"error\":\"Session not found\"}", "application/json");
-                        return;
-                    }
-                    session = it->second;
+                auto found = find_session(session_id);
+                if (!found) {
+                    res.status = 404;
+                    res.set_content("{\"error\":\"Session not found\"}", "application/json");
+                    return;
+                }
+                const SigningSession& session = *found;
+                std::string key = session.id.str();
+                
+                // A signed document seen before can answer a conditional GET
+                // from its remembered validators, without downloading it
+                std::optional<DocumentValidators::Validators> known;
+                if (session.status == SessionStatus::Signed) known = document_validators->get(key);
+                if (known && not_modified(req, known->etag, known->last_modified)) {
+                    set_document_headers(res, known->etag, known->last_modified);
+                    res.status = 304;
+                    return;
                 }
                 
-                // Get the PDF from Dropbox Sign
-                std::string pdf_content = get_file_binary(session.signature_request_id);
+                auto doc = load_document(session);
+                set_document_headers(res, doc->etag, doc->last_modified);
+                if (not_modified(req, doc->etag, doc->last_modified)) {
+                    res.status = 304;
+                    return;
+                }
                 
-                res.set_header("Content-Type", "application/pdf");
                 res.set_header("Content-Disposition", "attachment; filename=\"signed_document.pdf\"");
-                res.set_content(pdf_content, "application/pdf");
+                // A stale If-Range means the client's partial copy is outdated:
+                // send it all. httplib slices a content provider by req.ranges
+                // whatever the status, so the whole body goes out as plain
+                // content, and the Range is dropped so it can't end in a 416.
+                if (!req.ranges.empty() &&
+                    !if_range_matches(req.get_header_value("If-Range"), doc->etag, doc->last_modified)) {
+                    const_cast<Request&>(req).ranges.clear();
+                    res.set_content(doc->content, "application/pdf");
+                    return;
+                }
+                // httplib slices single and multi-range (multipart/byteranges) requests
+                // out of the provider, so the cached bytes are never copied per request
+                res.set_content_provider(
+                    doc->content.size(), "application/pdf",
+                    [doc](size_t offset, size_t length, DataSink& sink) {
+                        return sink.write(doc->content.data() + offset, length);
+                    });
+            } catch (const ProviderUnavailable& e) {
+                respond_unavailable(res, e);
+            } catch (const DeadlineExceeded& e) {
+                respond_deadline_exceeded(res, e);
             } catch (const std::exception& e) {
                 res.status = 500;
                 json error_response = {{"error", e.what()}};
                 res.set_content(error_response.dump(), "application/json");
             }
+        }));
+        
+        // Many documents as one ZIP archive (<session id>.pdf per entry), streamed
+        // as it is built: ?ids=a,b,c exports those sessions, ?created_from=T
+        // &created_to=T (Unix seconds, inclusive) every signed session created
+        // in that range. Documents are downloaded BATCH_CONCURRENCY at a time
+        // with a bounded read-ahead, so memory stays flat however large the
+        // archive gets. Documents that can't be fetched are listed in errors.txt.
+        server.Get("/api/documents:export", [this](const Request& req, Response& res) {
+            setup_cors(res);
+            log_request(req, "Export documents");
+            
+            auto sessions = std::make_shared<std::vector<SigningSession>>();
+            auto errors = std::make_shared<std::string>();
+            try {
+                if (req.has_param("ids")) {
+                    std::string ids = req.get_param_value("ids");
+                    size_t start = 0;
+                    while (start <= ids.size()) {
+                        size_t comma = std::min(ids.find(',', start), ids.size());
+                        std::string id = ids.substr(start, comma - start);
+                        start = comma + 1;
+                        if (id.empty()) continue;
+                        if (auto found = find_session(id)) {
+                            sessions->push_back(std::move(*found));
+                        } else {
+                            *errors += id + ": Session not found\n";
+                        }
+                    }
+                } else if (req.has_param("created_from") || req.has_param("created_to")) {
+                    // Pending sessions too: the provider may have completed them
+                    // since the last status check
+                    SessionQuery query;
+                    query.limit = 1000;
+                    if (req.has_param("created_from")) {
+                        query.created_from = std::stoll(req.get_param_value("created_from"));
+                    }
+                    if (req.has_param("created_to")) {
+                        query.created_to = std::stoll(req.get_param_value("created_to"));
+                    }
+                    do {
+                        SessionPage page = session_store.list(query);
+                        sessions->insert(sessions->end(), page.sessions.begin(), page.sessions.end());
+                        query.after = page.next_cursor;
+                    } while (!query.after.empty() && sessions->size() <= export_max_documents);
+                } else {
+                    res.status = 400;
+                    res.set_content("{\"error\":\"Specify ids or created_from/created_to\"}", "application/json");
+                    return;
+                }
+            } catch (const std::exception&) {
+                res.status = 400;
+                res.set_content("{\"error\":\"Invalid created_from/created_to\"}", "application/json");
+                return;
+            }
+            if (sessions->size() > export_max_documents) {
+                res.status = 413;
+                res.set_content(json{{"error", "Too many documents (max " + std::to_string(export_max_documents) + ")"}}.dump(),
+                                "application/json");
+                return;
+            }
+            
+            struct Fetched {
+                size_t index;
+                std::shared_ptr<const CachedDocument> doc;
+                std::string error;
+            };
+            auto batch = std::make_shared<std::unique_ptr<ParallelBatch<Fetched>>>();
+            res.set_header("Content-Disposition", "attachment; filename=\"signed_documents.zip\"");
+            res.set_chunked_content_provider("application/zip",
+                [this, sessions, errors, batch](size_t, DataSink& sink) {
+                    *batch = std::make_unique<ParallelBatch<Fetched>>(*batch_pool, sessions->size(), batch_concurrency,
+                        [this, sessions](size_t k) {
+                            RequestDeadline::Scope scope(RequestDeadline::Clock::now() + request_timeout);
+                            CallPriorityScope background(CallPriority::Background);
+                            try {
+                                // Only signed documents are archived; the rest go to errors.txt
+                                SigningSession& session = (*sessions)[k];
+                                session.status = current_status(session);
+                                if (session.status != SessionStatus::Signed) return Fetched{k, nullptr, "Not signed"};
+                                return Fetched{k, load_document(session), ""};
+                            } catch (const std::exception& e) {
+                                return Fetched{k, nullptr, e.what()};
+                            }
+                        },
+                        batch_concurrency);
+                    
+                    ZipStreamWriter zip;
+                    Fetched fetched;
+                    while ((*batch)->next(fetched)) {
+                        const SigningSession& session = (*sessions)[fetched.index];
+                        if (!fetched.doc) {
+                            *errors += session.id.str() + ": " + fetched.error + "\n";
+                            continue;
+                        }
+                        const std::string& content = fetched.doc->content;
+                        std::string header = zip.entry_header(session.id.str() + ".pdf", content.data(),
+                                                              content.size(), fetched.doc->last_modified);
+                        if (!sink.write(header.data(), header.size()) ||
+                            !sink.write(content.data(), content.size())) {
+                            (*batch)->cancel();  // client went away: stop downloading
+                            return false;
+                        }
+                    }
+                    
+                    std::string tail;
+                    if (!errors->empty()) {
+                        tail = zip.entry_header("errors.txt", errors->data(), errors->size(), std::time(nullptr));
+                        tail += *errors;
+                    }
+                    tail += zip.finish();
+                    if (!sink.write(tail.data(), tail.size())) return false;
+                    sink.done();
+                    return true;
+                });
         });
         
-        // List all sessions (for debugging)
-        server.Get("/api/sessions", [this](const Request& req, Response& res) {
+        // Routing state per signature provider: recent p95 latency and error
+        // rate, which decide where new sessions go
+        server.Get("/api/providers", [this](const Request&, Response& res) {
+            setup_cors(res);
+            
+            json providers_array = json::array();
+            for (const auto& stats : providers->stats()) {
+                if (!stats.enabled) continue;
+                json p95_by_call = json::object();
+                for (size_t k = 0; k < Providers::call_kinds; k++) {
+                    p95_by_call[Providers::call_name(static_cast<ProviderCall>(k))] = stats.p95_ms[k];
+                }
+                providers_array.push_back({
+                    {"name", stats.name},
+                    {"default", Providers::id_of(stats.name) == providers->default_id()},
+                    {"calls", stats.calls},
+                    {"p95_ms", p95_by_call},
+                    {"error_rate", stats.error_rate}
+                });
+            }
+            json response = {{"providers", providers_array}};
+            res.set_content(response.dump(), "application/json");
+        });
+        
+        // Look up sessions by provider identifier or signer email (webhooks,
+        // reconciliation, support): ?signature_request_id= | ?signature_id= | ?email=
+        server.Get("/api/sessions/lookup", compressed(api_compression, [this](const Request& req, Response& res) {
             setup_cors(res);
             
+            std::vector<SigningSession> matches;
+            if (req.has_param("signature_request_id")) {
+                if (auto session = session_store.find_by_signature_request_id(req.get_param_value("signature_request_id"))) {
+                    matches.push_back(*session);
+                }
+            } else if (req.has_param("signature_id")) {
+                if (auto session = session_store.find_by_signature_id(req.get_param_value("signature_id"))) {
+                    matches.push_back(*session);
+                }
+            } else if (req.has_param("email")) {
+                matches = session_store.find_by_signer_email(req.get_param_value("email"));
+            } else {
+                res.status = 400;
+                res.set_content("{\"error\":\"Specify signature_request_id, signature_id or email\"}", "application/json");
+                return;
+            }
+            
             json sessions_array = json::array();
-            {
-                std::lock_guard<std::mutex> lock(sessions_mutex);
-                for (const auto& [id, session] : signing_sessions) {
-                    sessions_array.push_back({
-                        {"id", session.id},
-                        {"status", session.status},
-                        {"signer", session.signer_info},
-                        {"created_at", session.created_at}
-                    });
+            for (const auto& session : matches) {
+                sessions_array.push_back({
+                    {"id", session.id.str()},
+                    {"signature_request_id", session.signature_request_id()},
+                    {"signature_id", session.signature_id()},
+                    {"provider", Providers::name_of(session.provider ? session.provider : providers->default_id())},
+                    {"status", to_string(session.status)},
+                    {"signer", signer_json(session)},
+                    {"created_at", SessionClock::to_unix(session.created_at)}
+                });
+            }
+            json response = {{"sessions", sessions_array}};
+            res.set_content(response.dump(), "application/json");
+        }));
+        
+        // List sessions, one page at a time:
+        //   ?limit=N (1-1000, default 100) &after=<next_cursor> &status=pending|signed
+        //   &created_from=T &created_to=T (inclusive, Unix seconds like created_at)
+        server.Get("/api/sessions", [this](const Request& req, Response& res) {
+            setup_cors(res);
+            
+            SessionQuery query;
+            try {
+                if (req.has_param("limit")) {
+                    long long limit = std::stoll(req.get_param_value("limit"));
+                    if (limit < 1 || limit > 1000) throw std::invalid_argument("limit");
+                    query.limit = static_cast<size_t>(limit);
+                }
+                if (req.has_param("created_from")) {
+                    query.created_from = std::stoll(req.get_param_value("created_from"));
+                }
+                if (req.has_param("created_to")) {
+                    query.created_to = std::stoll(req.get_param_value("created_to"));
+                }
+            } catch (const std::exception&) {
+                res.status = 400;
+                res.set_content("{\"error\":\"Invalid limit or created_at range\"}", "application/json");
+                return;
+            }
+            if (req.has_param("status")) {
+                query.status = parse_session_status(req.get_param_value("status"));
+                if (!query.status) {
+                    res.status = 400;
+                    res.set_content("{\"error\":\"Unknown status\"}", "application/json");
+                    return;
                 }
             }
+            query.after = req.get_param_value("after");
             
-            res.set_content(sessions_array.dump(), "application/json");
+            // Only the page is copied under the store's (shared) lock;
+            // serialization and compression happen after it is released
+            SessionPage page;
+            try {
+                page = session_store.list(query);
+            } catch (const std::invalid_argument& e) {
+                res.status = 400;
+                json error_response = {{"error", e.what()}};
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+            
+            auto sessions_array = std::make_shared<json>(json::array());
+            for (const auto& session : page.sessions) {
+                sessions_array->push_back({
+                    {"id", session.id.str()},
+                    {"status", to_string(session.status)},
+                    {"signer", signer_json(session)},
+                    {"created_at", SessionClock::to_unix(session.created_at)}
+                });
+            }
+            json next_cursor = page.next_cursor.empty() ? json(nullptr) : json(page.next_cursor);
+            
+            const size_t stream_threshold = 512;  // entries
+            if (sessions_array->size() < stream_threshold) {
+                json response = {
+                    {"sessions", std::move(*sessions_array)},
+                    {"next_cursor", next_cursor}
+                };
+                res.set_content(response.dump(), "application/json");
+                compress_body(req, res, listing_compression);
+                return;
+            }
+            
+            // Large listings are serialized and compressed slice by slice on a chunked
+            // response, so neither the full JSON text nor its compressed copy is buffered
+            ContentEncoding encoding = listing_compression.choose(req.get_header_value("Accept-Encoding"));
+            if (encoding != ContentEncoding::Identity) {
+                res.set_header("Content-Encoding", content_encoding_token(encoding));
+            }
+            res.set_header("Vary", "Accept-Encoding");
+            
+            auto compressor = std::make_shared<StreamCompressor>(encoding, listing_compression.level);
+            auto next = std::make_shared<size_t>(0);
+            res.set_chunked_content_provider("application/json",
+                [sessions_array, next_cursor, compressor, next](size_t, DataSink& sink) {
+                    const size_t slice = 256;
+                    const size_t total = sessions_array->size();
+                    
+                    std::string text = (*next == 0) ? "{\"sessions\":[" : "";
+                    size_t end = std::min(*next + slice, total);
+                    for (size_t i = *next; i < end; i++) {
+                        if (i > 0) text += ',';
+                        text += (*sessions_array)[i].dump();
+                    }
+                    *next = end;
+                    bool last = (end == total);
+                    if (last) text += "],\"next_cursor\":" + next_cursor.dump() + "}";
+                    
+                    std::string out;
+                    compressor->compress(text.data(), text.size(), last, out);
+                    if (!out.empty() && !sink.write(out.data(), out.size())) return false;
+                    if (last) sink.done();
+                    return true;
+                });
         });
     }
     
@@ -823,15 +1495,49 @@ public:
         std::cout << "Document Signing Server starting on port " << port << std::endl;
         std::cout << "Frontend available at: http://localhost:" << port << "/" << std::endl;
         std::cout << "API endpoint: http://localhost:" << port << "/api/" << std::endl;
-        std::cout << "Using " << signature_provider << " API for signatures" << std::endl;
+        for (const auto& stats : providers->stats()) {
+            if (stats.enabled) std::cout << "Using " << stats.name << " API for signatures" << std::endl;
+        }
         
+        std::cout << "Handler threads: " << server_threads << ", batch threads: " << batch_workers << std::endl;
+        server.new_task_queue = [threads = server_threads, queued = server_max_queued] {
+            return new ThreadPool(threads, queued);
+        };
+        batch_pool = std::make_unique<ThreadPool>(batch_workers);
         setup_routes();
+        session_expiry->start();
+        if (sign_url_cache) sign_url_cache->start();
         server.listen("0.0.0.0", port);
+        stop_batches();
+    }
+    
+    // Waits for batch items still running after their request ended
+    void stop_batches() {
+        if (!batch_pool) return;
+        batch_pool->shutdown();
+        batch_pool.reset();
     }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench-session-ids") {
+        size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+        unsigned threads = argc > 3 ? std::atoi(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+        return diagnostics::bench_session_ids(count, threads);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--memory-report") {
+        size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+        return diagnostics::memory_report(count);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--warm-start-report") {
+        size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000000;
+        std::string dir = argc > 3 ? argv[3] : "/tmp";
+        return diagnostics::warm_start_report(count, dir);
+    }
+    
     try {
+        // Load .env file if it exists
+        load_env_file();
         DocumentSigningServer server;
         server.start(8080);
     } catch (const std::exception& e) {
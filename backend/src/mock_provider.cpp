@@ -0,0 +1,451 @@
+// Stand-in for the Dropbox Sign and BoldSign APIs, for load and latency tests
+// of the server's real provider client path on one machine. It serves every
+// endpoint the signing server calls over HTTPS, with a self-signed certificate
+// generated at startup and written to --cert-out so the server can trust it:
+//
+//   ./mock-provider --latency '*=80/600' --error-rate 0.01 --rate-limit 100/60
+//   export DROPBOX_SIGN_BASE_URL=https://localhost:9443 PROVIDER_CA_CERT_FILE=mock-provider.pem
+//   DROPBOX_SIGN_API_KEY=... ./signing-server
+//
+// Options:
+//   --port N                  listen port (9443)
+//   --cert-out FILE           where to write the certificate (mock-provider.pem)
+//   --threads N               handler threads (256)
+//   --latency EP=MED[/P99]    log-normal latency in ms for endpoint EP (create,
+//                             template, sign_url, status, download, or * for
+//                             all); fixed at MED without a p99. Repeatable.
+//   --error-rate R            fraction of calls answered 502/503 (0)
+//   --rate-limit N/SECONDS    calls allowed per API key and window, with
+//                             rate-limit headers and 429 beyond it (off)
+//   --document-kb N           size of downloaded PDFs (256)
+//   --sign-after SECONDS      documents report as signed this long after
+//                             creation (30; 0 = only via the signing page)
+//   --seed N                  random seed, for repeatable runs
+//
+// API keys are not checked beyond being present. Documents live in memory.
+
+#include <iostream>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+#include "httplib.h"
+#include "json.hpp"
+
+using json = nlohmann::json;
+using namespace httplib;
+
+// Log-normal call latency given its median and 99th percentile
+struct LatencyModel {
+    double median_ms = 0;
+    double sigma = 0;
+
+    static LatencyModel parse(const std::string& value) {
+        LatencyModel model;
+        size_t slash = value.find('/');
+        model.median_ms = std::atof(value.substr(0, slash).c_str());
+        if (slash != std::string::npos) {
+            double p99_ms = std::atof(value.c_str() + slash + 1);
+            if (model.median_ms > 0 && p99_ms > model.median_ms) {
+                model.sigma = std::log(p99_ms / model.median_ms) / 2.326;  // z-score of p99
+            }
+        }
+        return model;
+    }
+
+    std::chrono::milliseconds sample(std::mt19937_64& rng) const {
+        if (median_ms <= 0) return std::chrono::milliseconds(0);
+        if (sigma <= 0) return std::chrono::milliseconds(static_cast<int64_t>(median_ms));
+        std::lognormal_distribution<double> distribution(std::log(median_ms), sigma);
+        return std::chrono::milliseconds(static_cast<int64_t>(distribution(rng)));
+    }
+};
+
+struct MockOptions {
+    int port = 9443;
+    std::string cert_out = "mock-provider.pem";
+    size_t threads = 256;
+    std::map<std::string, LatencyModel> latency;  // by endpoint, "*" = default
+    double error_rate = 0;
+    unsigned rate_limit = 0;  // calls per window, 0 = unlimited
+    unsigned rate_window = 60;
+    size_t document_kb = 256;
+    int sign_after = 30;
+    uint64_t seed = std::random_device{}();
+};
+
+// Self-signed P-256 certificate for localhost/127.0.0.1. The key identifiers
+// and its own subject name let it share a CA bundle with other local certs.
+static void make_certificate(EVP_PKEY*& key, X509*& cert) {
+    key = EVP_EC_gen("P-256");
+    cert = X509_new();
+    if (!key || !cert) throw std::runtime_error("Failed to create certificate");
+    X509_set_version(cert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), static_cast<long>(std::time(nullptr)));
+    X509_gmtime_adj(X509_getm_notBefore(cert), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 30L * 24 * 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("mock-provider"), -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+
+    X509V3_CTX ctx;
+    X509V3_set_ctx_nodb(&ctx);
+    X509V3_set_ctx(&ctx, cert, cert, nullptr, nullptr, 0);
+    const std::pair<int, const char*> extensions[] = {
+        {NID_basic_constraints, "critical,CA:TRUE"},
+        {NID_key_usage, "critical,digitalSignature,keyCertSign"},
+        {NID_subject_alt_name, "DNS:localhost,IP:127.0.0.1"},
+        {NID_subject_key_identifier, "hash"},
+        {NID_authority_key_identifier, "keyid:always"},
+    };
+    for (const auto& [nid, value] : extensions) {
+        X509_EXTENSION* extension = X509V3_EXT_conf_nid(nullptr, &ctx, nid, value);
+        if (!extension) throw std::runtime_error("Failed to create certificate extension");
+        X509_add_ext(cert, extension, -1);
+        X509_EXTENSION_free(extension);
+    }
+    if (!X509_sign(cert, key, EVP_sha256())) throw std::runtime_error("Failed to sign certificate");
+}
+
+// A one-page PDF padded to about `size` bytes with comment lines in the page
+// content, so it stays valid whatever the size
+static std::string make_pdf(size_t size) {
+    std::string content = "BT /F1 24 Tf 72 720 Td (Signed document - mock provider) Tj ET\n";
+    std::string line = "%" + std::string(78, 'x') + "\n";
+    while (content.size() + line.size() + 400 < size) content += line;
+
+    std::vector<std::string> objects = {
+        "<< /Type /Catalog /Pages 2 0 R >>",
+        "<< /Type /Pages /Kids [3 0 R] /Count 1 >>",
+        "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] /Contents 4 0 R "
+        "/Resources << /Font << /F1 5 0 R >> >> >>",
+        "<< /Length " + std::to_string(content.size()) + " >>\nstream\n" + content + "endstream",
+        "<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>",
+    };
+    std::string pdf = "%PDF-1.4\n";
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < objects.size(); i++) {
+        offsets.push_back(pdf.size());
+        pdf += std::to_string(i + 1) + " 0 obj\n" + objects[i] + "\nendobj\n";
+    }
+    size_t xref = pdf.size();
+    pdf += "xref\n0 " + std::to_string(objects.size() + 1) + "\n0000000000 65535 f \n";
+    for (size_t offset : offsets) {
+        char entry[21];
+        std::snprintf(entry, sizeof(entry), "%010zu 00000 n \n", offset);
+        pdf += entry;
+    }
+    pdf += "trailer\n<< /Size " + std::to_string(objects.size() + 1) + " /Root 1 0 R >>\nstartxref\n" +
+           std::to_string(xref) + "\n%%EOF\n";
+    return pdf;
+}
+
+class MockProvider {
+public:
+    explicit MockProvider(MockOptions options) : options(std::move(options)) {
+        pdf = make_pdf(this->options.document_kb * 1024);
+    }
+
+    int run() {
+        EVP_PKEY* key = nullptr;
+        X509* cert = nullptr;
+        make_certificate(key, cert);
+        FILE* file = std::fopen(options.cert_out.c_str(), "w");
+        if (!file || !PEM_write_X509(file, cert)) {
+            std::cerr << "Cannot write certificate to " << options.cert_out << std::endl;
+            return 1;
+        }
+        std::fclose(file);
+
+        SSLServer server(cert, key);
+        X509_free(cert);
+        EVP_PKEY_free(key);
+        if (!server.is_valid()) {
+            std::cerr << "Failed to set up TLS" << std::endl;
+            return 1;
+        }
+        server.new_task_queue = [threads = options.threads] { return new ThreadPool(threads); };
+        base_url = "https://localhost:" + std::to_string(options.port);
+        setup_dropbox_sign(server);
+        setup_boldsign(server);
+        setup_signing_page(server);
+
+        std::cout << "Mock provider listening on " << base_url << " (certificate: " << options.cert_out << ")"
+                  << std::endl;
+        std::cout << "Error rate " << options.error_rate << ", rate limit ";
+        if (options.rate_limit) {
+            std::cout << options.rate_limit << "/" << options.rate_window << "s";
+        } else {
+            std::cout << "off";
+        }
+        std::cout << ", documents " << pdf.size() << " bytes, signed after " << options.sign_after << "s"
+                  << std::endl;
+        return server.listen("0.0.0.0", options.port) ? 0 : 1;
+    }
+
+private:
+    enum class Api { DropboxSign, BoldSign };
+
+    struct Document {
+        std::chrono::steady_clock::time_point created;
+        bool signed_now = false;  // completed on the signing page
+    };
+
+    struct Window {
+        std::time_t start = 0;
+        unsigned count = 0;
+    };
+
+    MockOptions options;
+    std::string pdf;
+    std::string base_url;
+    std::unordered_map<std::string, Document> documents;
+    std::unordered_map<std::string, Window> windows;  // per API key
+    std::mutex mutex;
+
+    std::mt19937_64& rng() {
+        thread_local std::mt19937_64 generator(
+            options.seed ^ std::hash<std::thread::id>()(std::this_thread::get_id()));
+        return generator;
+    }
+
+    std::string new_id() {
+        std::uniform_int_distribution<uint64_t> pick;
+        char id[33];
+        std::snprintf(id, sizeof(id), "%016llx%016llx", static_cast<unsigned long long>(pick(rng())),
+                      static_cast<unsigned long long>(pick(rng())));
+        return id;
+    }
+
+    std::string create_document() {
+        std::string id = new_id();
+        std::lock_guard<std::mutex> lock(mutex);
+        documents[id] = Document{std::chrono::steady_clock::now()};
+        return id;
+    }
+
+    // Whether the document exists, and whether it has been signed
+    bool document_status(const std::string& id, bool& complete) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = documents.find(id);
+        if (it == documents.end()) return false;
+        complete = it->second.signed_now ||
+                   (options.sign_after > 0 &&
+                    std::chrono::steady_clock::now() - it->second.created >= std::chrono::seconds(options.sign_after));
+        return true;
+    }
+
+    // Wraps a handler with what a real provider does to every call: an auth
+    // check, rate limiting (with the API's own header names), latency and
+    // injected server errors
+    Server::Handler endpoint(const char* name, Api api, Server::Handler handler) {
+        return [this, name, api, handler](const Request& req, Response& res) {
+            std::string key = api == Api::DropboxSign ? req.get_header_value("Authorization")
+                                                      : req.get_header_value("X-API-KEY");
+            if (key.empty()) {
+                res.status = 401;
+                res.set_content(json{{"error", "Missing API key"}}.dump(), "application/json");
+                return;
+            }
+            if (!admit(key, api, res)) return;
+
+            // Read-only once serving (main() always sets "*"), so no operator[] here
+            auto found = options.latency.find(name);
+            const LatencyModel& latency = found != options.latency.end() ? found->second : options.latency.at("*");
+            std::this_thread::sleep_for(latency.sample(rng()));
+
+            if (options.error_rate > 0 && std::uniform_real_distribution<double>(0, 1)(rng()) < options.error_rate) {
+                res.status = std::uniform_int_distribution<int>(0, 1)(rng()) ? 503 : 502;
+                res.set_content(json{{"error", "Injected failure"}}.dump(), "application/json");
+                return;
+            }
+            handler(req, res);
+        };
+    }
+
+    // Fixed-window rate limit per API key; false (with a 429) once exhausted
+    bool admit(const std::string& key, Api api, Response& res) {
+        if (options.rate_limit == 0) return true;
+        std::time_t now = std::time(nullptr);
+        unsigned count;
+        std::time_t reset;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Window& window = windows[key];
+            if (now - window.start >= static_cast<std::time_t>(options.rate_window)) window = Window{now, 0};
+            count = ++window.count;
+            reset = window.start + options.rate_window;
+        }
+        unsigned remaining = count >= options.rate_limit ? 0 : options.rate_limit - count;
+        bool dropbox = api == Api::DropboxSign;
+        res.set_header(dropbox ? "X-Ratelimit-Limit" : "X-RateLimit-Limit", std::to_string(options.rate_limit));
+        res.set_header(dropbox ? "X-Ratelimit-Limit-Remaining" : "X-RateLimit-Remaining", std::to_string(remaining));
+        res.set_header(dropbox ? "X-Ratelimit-Reset" : "X-RateLimit-Reset", std::to_string(reset));
+        if (count <= options.rate_limit) return true;
+        res.status = 429;
+        res.set_header("Retry-After", std::to_string(std::max<std::time_t>(1, reset - now)));
+        res.set_content(json{{"error", "Rate limit exceeded"}}.dump(), "application/json");
+        return false;
+    }
+
+    void not_found(Response& res) {
+        res.status = 404;
+        res.set_content(json{{"error", "Not found"}}.dump(), "application/json");
+    }
+
+    void setup_dropbox_sign(Server& server) {
+        auto created = [this](const Request&, Response& res) {
+            std::string id = create_document();
+            json signature_request = {
+                {"signature_request_id", id},
+                {"signatures", json::array({{{"signature_id", id}}})}
+            };
+            res.set_content(json{{"signature_request", signature_request}}.dump(), "application/json");
+        };
+        server.Post("/v3/signature_request/create_embedded", endpoint("create", Api::DropboxSign, created));
+        server.Post("/v3/signature_request/create_embedded_with_template",
+                    endpoint("create", Api::DropboxSign, created));
+
+        server.Post("/v3/template/create", endpoint("template", Api::DropboxSign, [this](const Request&, Response& res) {
+            res.set_content(json{{"template", {{"template_id", new_id()}}}}.dump(), "application/json");
+        }));
+
+        server.Get("/v3/embedded/sign_url/:id", endpoint("sign_url", Api::DropboxSign, [this](const Request& req, Response& res) {
+            bool complete;
+            std::string id = req.path_params.at("id");
+            if (!document_status(id, complete)) return not_found(res);
+            json embedded = {{"sign_url", base_url + "/sign/" + id}, {"expires_at", std::time(nullptr) + 3600}};
+            res.set_content(json{{"embedded", embedded}}.dump(), "application/json");
+        }));
+
+        server.Get("/v3/signature_request/:id", endpoint("status", Api::DropboxSign, [this](const Request& req, Response& res) {
+            bool complete;
+            if (!document_status(req.path_params.at("id"), complete)) return not_found(res);
+            res.set_content(json{{"signature_request", {{"is_complete", complete}}}}.dump(), "application/json");
+        }));
+
+        server.Get("/v3/signature_request/files/:id", endpoint("download", Api::DropboxSign, [this](const Request& req, Response& res) {
+            bool complete;
+            if (!document_status(req.path_params.at("id"), complete)) return not_found(res);
+            res.set_content(pdf, "application/pdf");
+        }));
+    }
+
+    void setup_boldsign(Server& server) {
+        auto created = [this](const Request&, Response& res) {
+            res.set_content(json{{"documentId", create_document()}}.dump(), "application/json");
+        };
+        server.Post("/v1/document/send", endpoint("create", Api::BoldSign, created));
+        server.Post("/v1/template/send", endpoint("create", Api::BoldSign, created));
+
+        server.Post("/v1/template/create", endpoint("template", Api::BoldSign, [this](const Request&, Response& res) {
+            res.set_content(json{{"templateId", new_id()}}.dump(), "application/json");
+        }));
+
+        server.Get("/v1/document/getEmbeddedSignLink", endpoint("sign_url", Api::BoldSign, [this](const Request& req, Response& res) {
+            bool complete;
+            std::string id = req.get_param_value("documentId");
+            if (!document_status(id, complete)) return not_found(res);
+            res.set_content(json{{"signLink", base_url + "/sign/" + id}}.dump(), "application/json");
+        }));
+
+        server.Get("/v1/document/properties", endpoint("status", Api::BoldSign, [this](const Request& req, Response& res) {
+            bool complete;
+            if (!document_status(req.get_param_value("documentId"), complete)) return not_found(res);
+            res.set_content(json{{"status", complete ? "Completed" : "InProgress"}}.dump(), "application/json");
+        }));
+
+        server.Get("/v1/document/download", endpoint("download", Api::BoldSign, [this](const Request& req, Response& res) {
+            bool complete;
+            if (!document_status(req.get_param_value("documentId"), complete)) return not_found(res);
+            res.set_content(pdf, "application/pdf");
+        }));
+    }
+
+    // The embedded signing page the URLs point at; its button completes the
+    // document and notifies the parent page like the demo page does
+    void setup_signing_page(Server& server) {
+        server.Get("/sign/:id", [this](const Request& req, Response& res) {
+            bool complete;
+            std::string id = req.path_params.at("id");
+            if (!document_status(id, complete)) return not_found(res);
+            res.set_content(
+                "<html><body style='font-family:Arial;text-align:center;padding:50px;'>"
+                "<h1>Mock Signing Interface</h1>"
+                "<button onclick=\"fetch('/sign/" + id + "/complete',{method:'POST'})"
+                ".then(()=>window.parent.postMessage('signing_complete','*'))\">Complete Signing</button>"
+                "</body></html>",
+                "text/html");
+        });
+        server.Post("/sign/:id/complete", [this](const Request& req, Response& res) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = documents.find(req.path_params.at("id"));
+            if (it == documents.end()) return not_found(res);
+            it->second.signed_now = true;
+            res.status = 204;
+        });
+    }
+};
+
+static int usage() {
+    std::cerr << "Usage: mock-provider [--port N] [--cert-out FILE] [--threads N] [--latency EP=MED[/P99]]...\n"
+                 "                     [--error-rate R] [--rate-limit N/SECONDS] [--document-kb N]\n"
+                 "                     [--sign-after SECONDS] [--seed N]" << std::endl;
+    return 2;
+}
+
+int main(int argc, char* argv[]) {
+    MockOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) return usage();
+        std::string value = argv[++i];
+        if (flag == "--port") {
+            options.port = std::atoi(value.c_str());
+        } else if (flag == "--cert-out") {
+            options.cert_out = value;
+        } else if (flag == "--threads") {
+            options.threads = std::max(1, std::atoi(value.c_str()));
+        } else if (flag == "--latency") {
+            size_t equals = value.find('=');
+            if (equals == std::string::npos) return usage();
+            options.latency[value.substr(0, equals)] = LatencyModel::parse(value.substr(equals + 1));
+        } else if (flag == "--error-rate") {
+            options.error_rate = std::atof(value.c_str());
+        } else if (flag == "--rate-limit") {
+            size_t slash = value.find('/');
+            options.rate_limit = static_cast<unsigned>(std::atoi(value.c_str()));
+            if (slash != std::string::npos) options.rate_window = std::max(1, std::atoi(value.c_str() + slash + 1));
+        } else if (flag == "--document-kb") {
+            options.document_kb = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (flag == "--sign-after") {
+            options.sign_after = std::atoi(value.c_str());
+        } else if (flag == "--seed") {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else {
+            return usage();
+        }
+    }
+    options.latency.emplace("*", LatencyModel{});  // no-op if --latency set one
+
+    try {
+        MockProvider mock(std::move(options));
+        return mock.run();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
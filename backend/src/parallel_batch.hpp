@@ -0,0 +1,130 @@
+#pragma once
+
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+#include "httplib.h"
+
+// Runs work(i) for every i in [0, count) as at most `concurrency` tasks on a
+// shared executor and hands the results back in completion order, so a caller
+// can stream them as they finish or stop waiting at a deadline. The executor
+// bounds the threads all batches use together; shut it down to wait for
+// their remaining items. cancel() (or destruction) stops new items from
+// starting; items already running finish in the background and their results
+// are dropped, so `work` must only capture what it owns.
+// With `max_buffered`, tasks stop starting items while that many finished
+// results are waiting to be taken, so a slow consumer bounds memory at roughly
+// concurrency + max_buffered results. A stopped task gives its executor
+// thread back and is queued again once a result has been taken.
+template <typename Result>
+class ParallelBatch {
+public:
+    using Work = std::function<Result(size_t)>;
+    enum class Wait { Ready, Done, Timeout };
+
+    ParallelBatch(httplib::TaskQueue& executor, size_t count, size_t concurrency, Work work,
+                  size_t max_buffered = std::numeric_limits<size_t>::max())
+        : state(std::make_shared<State>(executor, count, std::move(work), std::max<size_t>(max_buffered, 1))) {
+        size_t tasks = std::min(count, std::max<size_t>(concurrency, 1));
+        state->running = tasks;
+        for (size_t t = 0; t < tasks; t++) State::schedule(state);
+    }
+
+    ~ParallelBatch() { cancel(); }
+
+    ParallelBatch(const ParallelBatch&) = delete;
+    ParallelBatch& operator=(const ParallelBatch&) = delete;
+
+    // Blocks for the next finished result; false once every started item has
+    // been handed out
+    bool next(Result& out) {
+        return next_until(out, std::chrono::steady_clock::time_point::max()) == Wait::Ready;
+    }
+
+    // Like next(), but gives up at `deadline`
+    Wait next_until(Result& out, std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        auto available = [this] { return !state->results.empty() || state->running == 0; };
+        if (deadline == std::chrono::steady_clock::time_point::max()) {
+            state->ready.wait(lock, available);
+        } else if (!state->ready.wait_until(lock, deadline, available)) {
+            return Wait::Timeout;
+        }
+        if (state->results.empty()) return Wait::Done;
+        out = std::move(state->results.front());
+        state->results.pop_front();
+        bool resume = state->parked > 0 && !state->cancelled;
+        if (resume) state->parked--;
+        lock.unlock();
+        if (resume) State::schedule(state);
+        return Wait::Ready;
+    }
+
+    void cancel() {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->cancelled = true;
+            state->running -= state->parked;
+            state->parked = 0;
+        }
+        state->ready.notify_all();
+    }
+
+private:
+    struct State {
+        httplib::TaskQueue& executor;
+        size_t count;
+        Work work;
+        size_t max_buffered;
+        std::atomic<size_t> next_index{0};
+        bool cancelled = false;
+
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<Result> results;
+        size_t running = 0;  // tasks not yet finished, parked ones included
+        size_t parked = 0;   // tasks stopped on a full buffer
+
+        State(httplib::TaskQueue& executor, size_t count, Work work, size_t max_buffered)
+            : executor(executor), count(count), work(std::move(work)), max_buffered(max_buffered) {}
+
+        static void schedule(const std::shared_ptr<State>& state) {
+            if (state->executor.enqueue([state] { state->run(); })) return;
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->running--;
+            state->ready.notify_all();
+        }
+
+        void run() {
+            while (true) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (cancelled) break;
+                    if (results.size() >= max_buffered) {
+                        parked++;
+                        return;
+                    }
+                }
+                size_t i = next_index++;
+                if (i >= count) break;
+                Result result = work(i);
+                std::lock_guard<std::mutex> lock(mutex);
+                results.push_back(std::move(result));
+                ready.notify_one();
+            }
+            // Out of items (or cancelled): parked tasks have nothing left to do
+            std::lock_guard<std::mutex> lock(mutex);
+            running -= parked + 1;
+            parked = 0;
+            ready.notify_all();
+        }
+    };
+
+    std::shared_ptr<State> state;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <stdexcept>
+
+// A provider call that didn't get the response it needed. `status` is the
+// HTTP status, or 0 if no response arrived. A definitive error (a 4xx other
+// than 429) means the provider understood and refused the request, so neither
+// a retry nor another provider would do better.
+class ProviderError : public std::runtime_error {
+public:
+    ProviderError(const std::string& message, int status) : std::runtime_error(message), status(status) {}
+
+    bool definitive() const { return status > 0 && status < 500 && status != 429; }
+
+    int status;
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+
+// Thrown instead of calling a provider that is failing or saturated; handlers
+// answer 503 with Retry-After
+class ProviderUnavailable : public std::runtime_error {
+public:
+    ProviderUnavailable(const std::string& message, std::chrono::seconds retry_after)
+        : std::runtime_error(message), retry_after(retry_after) {}
+
+    std::chrono::seconds retry_after;
+};
+
+// Protects one provider endpoint with a circuit breaker and an adaptive (AIMD)
+// concurrency limit, so a degraded provider costs callers an immediate error
+// instead of a handler thread stuck until the socket times out.
+//
+// Breaker: `failure_threshold` consecutive failures (transport errors, 5xx,
+// 429) open it for `open_duration`; after that one probe call is let through
+// (half-open), and its result closes or re-opens the breaker.
+//
+// Limiter: at most `limit` calls in flight. Each fast success raises the limit
+// by 1/limit (about +1 per limit's worth of calls); a failure or a call slower
+// than `latency_target` multiplies it by `backoff`.
+class ProviderGuard {
+public:
+    struct Options {
+        unsigned failure_threshold = 5;
+        std::chrono::milliseconds open_duration{10000};
+        double initial_limit = 20;
+        double min_limit = 1;
+        double max_limit = 200;
+        std::chrono::milliseconds latency_target{2000};
+        double backoff = 0.8;
+    };
+
+    enum class State { Closed, Open, HalfOpen };
+
+    // One admitted call; report its outcome with finish(), or abandon() it
+    // when the call was cut short by our own deadline rather than the
+    // provider (destruction without either counts as a failure)
+    class Permit {
+    public:
+        Permit(ProviderGuard* guard, bool probe)
+            : guard(guard), probe(probe), start(std::chrono::steady_clock::now()) {}
+        Permit(Permit&& other) noexcept : guard(other.guard), probe(other.probe), start(other.start) {
+            other.guard = nullptr;
+        }
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+        ~Permit() { finish(false); }
+
+        void finish(bool ok) {
+            if (!guard) return;
+            guard->release(ok, probe, std::chrono::steady_clock::now() - start);
+            guard = nullptr;
+        }
+
+        void abandon() {
+            if (!guard) return;
+            guard->release_unjudged(probe);
+            guard = nullptr;
+        }
+
+    private:
+        ProviderGuard* guard;
+        bool probe;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    ProviderGuard(std::string name, Options options)
+        : name(std::move(name)), options(options), limit(options.initial_limit) {}
+
+    // Admits a call or throws ProviderUnavailable
+    Permit acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto now = std::chrono::steady_clock::now();
+        if (state == State::Open) {
+            if (now < open_until) {
+                auto wait = std::chrono::duration_cast<std::chrono::seconds>(open_until - now) + std::chrono::seconds(1);
+                throw ProviderUnavailable(name + " is failing; circuit open", wait);
+            }
+            state = State::HalfOpen;
+            probing = false;
+        }
+        if (state == State::HalfOpen && probing) {
+            throw ProviderUnavailable(name + " is recovering; circuit half-open", std::chrono::seconds(1));
+        }
+        if (in_flight >= static_cast<size_t>(limit)) {
+            throw ProviderUnavailable(name + " is at its concurrency limit (" +
+                                      std::to_string(static_cast<size_t>(limit)) + ")", std::chrono::seconds(1));
+        }
+        bool probe = state == State::HalfOpen;
+        if (probe) probing = true;
+        in_flight++;
+        return Permit(this, probe);
+    }
+
+    State current_state() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return state;
+    }
+
+    double current_limit() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return limit;
+    }
+
+private:
+    std::string name;
+    Options options;
+    std::mutex mutex;
+    State state = State::Closed;
+    std::chrono::steady_clock::time_point open_until;
+    bool probing = false;
+    unsigned consecutive_failures = 0;
+    double limit;
+    size_t in_flight = 0;
+
+    void release_unjudged(bool probe) {
+        std::lock_guard<std::mutex> lock(mutex);
+        in_flight--;
+        if (probe) probing = false;
+    }
+
+    void release(bool ok, bool probe, std::chrono::steady_clock::duration latency) {
+        std::lock_guard<std::mutex> lock(mutex);
+        in_flight--;
+        if (probe) probing = false;
+
+        bool slow = latency > options.latency_target;
+        if (ok && !slow) {
+            limit = std::min(options.max_limit, limit + 1 / limit);
+        } else {
+            limit = std::max(options.min_limit, limit * options.backoff);
+        }
+
+        if (ok) {
+            consecutive_failures = 0;
+            if (state == State::HalfOpen) {
+                state = State::Closed;
+                std::cerr << name << " recovered; circuit closed" << std::endl;
+            }
+            return;
+        }
+        consecutive_failures++;
+        if (state == State::HalfOpen || (state == State::Closed && consecutive_failures >= options.failure_threshold)) {
+            state = State::Open;
+            open_until = std::chrono::steady_clock::now() + options.open_duration;
+            std::cerr << name << " failing; circuit open for " << options.open_duration.count() << " ms" << std::endl;
+        }
+    }
+};
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <tuple>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "provider_error.hpp"
+#include "provider_guard.hpp"
+
+template <typename T>
+struct ProviderTag {
+    using type = T;
+};
+
+// What a routed call does. Latency is tracked per kind, and providers are
+// ranked on document creation alone: a slow signing-URL or status call (say,
+// BoldSign waiting for a new document to be processed) says nothing about how
+// fast the next document goes out.
+enum class ProviderCall { Create, SignUrl, Status, Download };
+
+// Routes provider calls across every configured signature provider. Providers
+// are identified by their 1-based position in the type list (the ID stored in
+// each session; 0 means the default provider). call() runs an operation on one
+// provider, instantiated per provider type, and records how it went: latency
+// over the last `window` calls of that kind (for the p95) and an exponentially
+// weighted error rate. ranked() orders providers best first by create p95 and
+// error rate, so new sessions go to whichever is currently fast and healthy
+// while existing sessions stay pinned to the provider that holds their
+// document. A provider that hasn't created a document for `probe_interval` is
+// tried first once, so one that recovered from an outage gets traffic again.
+// A call its ProviderGuard refused counts as an error but adds no latency
+// sample, since nothing was sent. A definitive ProviderError (the provider
+// refused the request itself) is no sign of ill health and counts as answered.
+template <typename... Providers>
+class ProviderRouter {
+public:
+    static constexpr size_t provider_count = sizeof...(Providers);
+
+    static constexpr size_t call_kinds = 4;
+
+    struct Stats {
+        const char* name;
+        bool enabled;
+        uint64_t calls;
+        std::array<double, call_kinds> p95_ms;  // by ProviderCall
+        double error_rate;
+    };
+
+    static const char* call_name(ProviderCall kind) {
+        const char* names[] = {"create", "sign_url", "status", "download"};
+        return names[static_cast<size_t>(kind)];
+    }
+
+    explicit ProviderRouter(std::chrono::milliseconds probe_interval = std::chrono::seconds(30))
+        : probe_interval(probe_interval) {}
+
+    // Calls fn(ProviderTag<P>{}) for every provider type
+    template <typename Fn>
+    static void each_type(Fn&& fn) {
+        (fn(ProviderTag<Providers>{}), ...);
+    }
+
+    // ID for a provider name, or 0 if there is no such provider
+    static uint8_t id_of(std::string_view name) {
+        uint8_t id = 0, i = 0;
+        ((++i, name == Providers::name ? (void)(id = i) : (void)0), ...);
+        return id;
+    }
+
+    static const char* name_of(uint8_t id) {
+        const char* names[] = {Providers::name...};
+        return id >= 1 && id <= provider_count ? names[id - 1] : "unknown";
+    }
+
+    template <typename P>
+    void enable(std::unique_ptr<P> provider) {
+        std::get<std::unique_ptr<P>>(providers) = std::move(provider);
+        if (default_provider == 0) default_provider = id_for<P>();
+    }
+
+    void set_default(uint8_t id) { default_provider = id; }
+    uint8_t default_id() const { return default_provider; }
+
+    bool enabled(uint8_t id) const {
+        bool found = false;
+        uint8_t i = 0;
+        ((++i, i == id && std::get<std::unique_ptr<Providers>>(providers) ? (void)(found = true) : (void)0), ...);
+        return found;
+    }
+
+    // Enabled provider IDs, best candidate first
+    std::vector<uint8_t> ranked() {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<std::pair<double, uint8_t>> scored;
+        bool probing = false;
+        for (uint8_t id = 1; id <= provider_count; id++) {
+            if (!enabled(id)) continue;
+            Health& h = health[id - 1];
+            Latency& create = h.latency[static_cast<size_t>(ProviderCall::Create)];
+            double score = (create.p95_ms + 1) * (1 + 20 * h.error_rate);
+            if (!probing && (create.calls == 0 || now - h.last_create >= probe_interval)) {
+                score = -1;
+                probing = true;
+                h.last_create = now;  // one probe per interval, not one per concurrent request
+            }
+            scored.emplace_back(score, id);
+        }
+        std::sort(scored.begin(), scored.end(), [this](const auto& a, const auto& b) {
+            if (a.first != b.first) return a.first < b.first;
+            return (a.second == default_provider) > (b.second == default_provider);
+        });
+        std::vector<uint8_t> ids;
+        for (const auto& entry : scored) ids.push_back(entry.second);
+        return ids;
+    }
+
+    // Runs fn(provider) on provider `id` (0 = default) and records the outcome
+    // under `kind`. Throws if that provider isn't configured.
+    template <typename Fn>
+    auto call(uint8_t id, ProviderCall kind, Fn&& fn) {
+        if (id == 0) id = default_provider;
+        if (!enabled(id)) {
+            throw std::runtime_error(std::string("Signature provider ") + name_of(id) + " is not configured");
+        }
+        auto start = std::chrono::steady_clock::now();
+        try {
+            auto result = visit(id, fn);
+            record(id, kind, start, true);
+            return result;
+        } catch (const ProviderUnavailable&) {
+            record(id, kind, start, false, false);
+            throw;
+        } catch (const ProviderError& e) {
+            record(id, kind, start, e.definitive());
+            throw;
+        } catch (...) {
+            record(id, kind, start, false);
+            throw;
+        }
+    }
+
+    std::vector<Stats> stats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<Stats> out;
+        for (uint8_t id = 1; id <= provider_count; id++) {
+            const Health& h = health[id - 1];
+            Stats stats{name_of(id), enabled(id), 0, {}, h.error_rate};
+            for (size_t k = 0; k < call_kinds; k++) {
+                stats.calls += h.latency[k].calls;
+                stats.p95_ms[k] = h.latency[k].p95_ms;
+            }
+            out.push_back(stats);
+        }
+        return out;
+    }
+
+private:
+    static constexpr size_t window = 64;
+    static constexpr double error_alpha = 0.2;
+
+    struct Latency {
+        std::array<double, window> samples_ms{};
+        uint64_t calls = 0;
+        double p95_ms = 0;
+    };
+
+    struct Health {
+        std::array<Latency, call_kinds> latency;  // by ProviderCall
+        double error_rate = 0;
+        std::chrono::steady_clock::time_point last_create;
+    };
+
+    std::tuple<std::unique_ptr<Providers>...> providers;
+    std::array<Health, provider_count> health;
+    uint8_t default_provider = 0;
+    std::chrono::milliseconds probe_interval;
+    std::mutex mutex;
+
+    template <typename P>
+    static constexpr uint8_t id_for() {
+        uint8_t id = 0, i = 0;
+        ((++i, std::is_same_v<P, Providers> ? (void)(id = i) : (void)0), ...);
+        return id;
+    }
+
+    template <size_t I = 0, typename Fn>
+    decltype(auto) visit(uint8_t id, Fn& fn) {
+        if constexpr (I + 1 < provider_count) {
+            if (id != I + 1) return visit<I + 1>(id, fn);
+        }
+        return fn(*std::get<I>(providers));
+    }
+
+    void record(uint8_t id, ProviderCall kind, std::chrono::steady_clock::time_point start, bool ok,
+                bool sample = true) {
+        auto now = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(now - start).count();
+        std::lock_guard<std::mutex> lock(mutex);
+        Health& h = health[id - 1];
+        h.error_rate = error_alpha * (ok ? 0.0 : 1.0) + (1 - error_alpha) * h.error_rate;
+        if (kind == ProviderCall::Create) h.last_create = now;
+        if (!sample) return;
+        Latency& l = h.latency[static_cast<size_t>(kind)];
+        l.samples_ms[l.calls % window] = ms;
+        l.calls++;
+        size_t n = std::min<uint64_t>(l.calls, window);
+        std::array<double, window> sorted = l.samples_ms;
+        auto p95 = sorted.begin() + (n * 95) / 100;
+        std::nth_element(sorted.begin(), p95, sorted.begin() + n);
+        l.p95_ms = *p95;
+    }
+};
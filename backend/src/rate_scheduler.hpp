@@ -0,0 +1,167 @@
+#pragma once
+
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+#include <algorithm>
+#include "httplib.h"
+#include "provider_guard.hpp"
+
+// Interactive calls (a user waiting on a create or a signing URL) go ahead of
+// background ones (status polling, batches, exports). Set per thread: a Scope
+// marks everything the current request or batch item does as background.
+enum class CallPriority { Interactive, Background };
+
+class CallPriorityScope {
+public:
+    explicit CallPriorityScope(CallPriority priority) : previous(current()) { current() = priority; }
+    ~CallPriorityScope() { current() = previous; }
+    CallPriorityScope(const CallPriorityScope&) = delete;
+    CallPriorityScope& operator=(const CallPriorityScope&) = delete;
+
+    static CallPriority get() { return current(); }
+
+private:
+    CallPriority previous;
+
+    static CallPriority& current() {
+        thread_local CallPriority priority = CallPriority::Interactive;
+        return priority;
+    }
+};
+
+// Keeps one class of provider calls under the provider's rate limit with a
+// token bucket (`rate` per second, up to `burst` saved). Background calls may
+// only use tokens above a reserve and yield to any waiting interactive call,
+// so bulk status checks can't use up the allowance a signer is waiting on.
+// The provider's own accounting wins when it reports it: rate-limit headers
+// cap the local balance and pause the bucket until the window resets, as does
+// a 429 with Retry-After. A call that can't get a token before `deadline` (or
+// within `max_wait`) is refused with ProviderUnavailable.
+class RateScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Limit {
+        double rate;   // tokens per second
+        double burst;  // bucket size
+    };
+
+    RateScheduler(std::string name, Limit limit, double reserve_fraction = 0.2,
+                  std::chrono::milliseconds max_wait = std::chrono::seconds(10))
+        : name(std::move(name)), limit(limit), reserve(limit.burst * reserve_fraction),
+          max_wait(max_wait), tokens(limit.burst), refilled(Clock::now()) {}
+
+    void acquire(CallPriority priority, Clock::time_point deadline) {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto give_up = std::min(deadline, Clock::now() + max_wait);
+        size_t& queue = priority == CallPriority::Interactive ? interactive_waiting : background_waiting;
+        queue++;
+        while (true) {
+            auto now = Clock::now();
+            refill_locked(now);
+            double floor = priority == CallPriority::Background ? reserve : 0;
+            bool yield = priority == CallPriority::Background && interactive_waiting > 0;
+            if (now >= paused_until && !yield && tokens >= 1 + floor) {
+                tokens -= 1;
+                queue--;
+                if (interactive_waiting == 0 && background_waiting > 0) available.notify_all();
+                return;
+            }
+
+            auto ready = now >= paused_until ? now : paused_until;
+            if (!yield && tokens < 1 + floor) {
+                ready += std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>((1 + floor - tokens) / limit.rate));
+            }
+            if (ready > give_up) {
+                queue--;
+                if (interactive_waiting == 0 && background_waiting > 0) available.notify_all();
+                auto wait = std::chrono::duration_cast<std::chrono::seconds>(ready - now) + std::chrono::seconds(1);
+                throw ProviderUnavailable(name + " is rate limited", wait);
+            }
+            // Yielding callers wait to be notified; the rest wake when enough
+            // tokens should have accrued
+            if (yield) {
+                available.wait_until(lock, give_up);
+            } else {
+                available.wait_until(lock, ready);
+            }
+        }
+    }
+
+    // Takes a token only if one is free now and nobody is waiting for one,
+    // for optional calls (hedges) that should never hold anything up
+    bool try_acquire(CallPriority priority) {
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        refill_locked(now);
+        double floor = priority == CallPriority::Background ? reserve : 0;
+        if (now < paused_until || interactive_waiting + background_waiting > 0 || tokens < 1 + floor) return false;
+        tokens -= 1;
+        return true;
+    }
+
+    // Adopts the provider's view of the limit from a response
+    void observe(const httplib::Result& res) {
+        if (!res) return;
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        refill_locked(now);
+
+        long long remaining = header_number(*res, "X-RateLimit-Remaining", "X-Ratelimit-Limit-Remaining");
+        long long reset = header_number(*res, "X-RateLimit-Reset", "X-Ratelimit-Reset");
+        if (remaining >= 0) tokens = std::min(tokens, static_cast<double>(remaining));
+        if ((remaining == 0 || res->status == 429) && reset >= 0) {
+            pause_locked(now, reset_delay(reset));
+        }
+        if (res->status == 429) {
+            tokens = 0;
+            long long retry_after = header_number(*res, "Retry-After", "Retry-After");
+            if (retry_after >= 0) pause_locked(now, std::chrono::seconds(retry_after));
+        }
+    }
+
+private:
+    std::string name;
+    Limit limit;
+    double reserve;
+    std::chrono::milliseconds max_wait;
+    std::mutex mutex;
+    std::condition_variable available;
+    double tokens;
+    Clock::time_point refilled;
+    Clock::time_point paused_until;
+    size_t interactive_waiting = 0;
+    size_t background_waiting = 0;
+
+    void refill_locked(Clock::time_point now) {
+        double seconds = std::chrono::duration<double>(now - refilled).count();
+        refilled = now;
+        if (now < paused_until) return;
+        tokens = std::min(limit.burst, tokens + seconds * limit.rate);
+    }
+
+    void pause_locked(Clock::time_point now, std::chrono::seconds delay) {
+        delay = std::min<std::chrono::seconds>(delay, std::chrono::hours(1));
+        paused_until = std::max(paused_until, now + delay);
+    }
+
+    // X-RateLimit-Reset is either a Unix time or seconds from now
+    static std::chrono::seconds reset_delay(long long reset) {
+        long long now = static_cast<long long>(std::time(nullptr));
+        if (reset > 1000000000LL) return std::chrono::seconds(std::max(0LL, reset - now));
+        return std::chrono::seconds(reset);
+    }
+
+    // Non-negative integer header value, or -1 if absent or malformed
+    static long long header_number(const httplib::Response& res, const char* name, const char* alternate) {
+        std::string value = res.get_header_value(name);
+        if (value.empty()) value = res.get_header_value(alternate);
+        if (value.empty() || !std::all_of(value.begin(), value.end(), ::isdigit)) return -1;
+        return std::strtoll(value.c_str(), nullptr, 10);
+    }
+};
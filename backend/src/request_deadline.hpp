@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+// Thrown when a request's deadline runs out before its provider work is done;
+// handlers answer 504
+class DeadlineExceeded : public std::runtime_error {
+public:
+    explicit DeadlineExceeded(const std::string& what) : std::runtime_error(what) {}
+};
+
+// The deadline of the inbound request the current thread is serving. A Scope
+// sets it for the duration of a handler (or of one batch item on a worker
+// thread); provider calls read it to cap socket timeouts and retries, so
+// upstream work never outlives the client waiting for it. Without a scope
+// there is no deadline.
+class RequestDeadline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    class Scope {
+    public:
+        explicit Scope(Clock::time_point deadline) : previous(current_deadline()) {
+            current_deadline() = deadline;
+        }
+        ~Scope() { current_deadline() = previous; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Clock::time_point previous;
+    };
+
+    static Clock::time_point get() { return current_deadline(); }
+
+    // Time left before the deadline (zero once it has passed)
+    static Clock::duration remaining() {
+        auto deadline = current_deadline();
+        if (deadline == Clock::time_point::max()) return Clock::duration::max();
+        auto now = Clock::now();
+        return deadline > now ? deadline - now : Clock::duration::zero();
+    }
+
+    static bool expired() { return remaining() == Clock::duration::zero(); }
+
+private:
+    static Clock::time_point& current_deadline() {
+        thread_local Clock::time_point deadline = Clock::time_point::max();
+        return deadline;
+    }
+};
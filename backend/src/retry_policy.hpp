@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <algorithm>
+
+// Caps retries across all provider calls at a fraction of first attempts, so
+// an outage doesn't multiply our traffic against a provider that is already
+// struggling. Each first attempt deposits `ratio` tokens and each retry
+// spends one; `min_per_second` tokens trickle in regardless so low-traffic
+// periods can still retry. The balance is capped so a quiet hour can't be
+// saved up for a storm.
+class RetryBudget {
+public:
+    RetryBudget(double ratio = 0.1, double min_per_second = 5, double max_tokens = 100)
+        : ratio(ratio), min_per_second(min_per_second), max_tokens(max_tokens),
+          tokens(max_tokens), refilled(std::chrono::steady_clock::now()) {}
+
+    void record_attempt() {
+        std::lock_guard<std::mutex> lock(mutex);
+        refill_locked();
+        tokens = std::min(max_tokens, tokens + ratio);
+    }
+
+    bool try_spend() {
+        std::lock_guard<std::mutex> lock(mutex);
+        refill_locked();
+        if (tokens < 1) return false;
+        tokens -= 1;
+        return true;
+    }
+
+private:
+    double ratio;
+    double min_per_second;
+    double max_tokens;
+    double tokens;
+    std::chrono::steady_clock::time_point refilled;
+    std::mutex mutex;
+
+    void refill_locked() {
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - refilled).count();
+        refilled = now;
+        tokens = std::min(max_tokens, tokens + seconds * min_per_second);
+    }
+};
+
+// "Decorrelated jitter" backoff: each delay is drawn uniformly from
+// [base, 3 * previous delay], capped. Spreads retries from many callers
+// apart while still growing roughly exponentially.
+class RetryBackoff {
+public:
+    RetryBackoff(std::chrono::milliseconds base, std::chrono::milliseconds cap)
+        : base(base), cap(cap), previous(base) {}
+
+    std::chrono::milliseconds next() {
+        thread_local std::mt19937_64 rng{std::random_device{}()};
+        auto upper = std::max(base.count(), previous.count() * 3);
+        std::uniform_int_distribution<long long> pick(base.count(), upper);
+        previous = std::min(cap, std::chrono::milliseconds(pick(rng)));
+        return previous;
+    }
+
+private:
+    std::chrono::milliseconds base;
+    std::chrono::milliseconds cap;
+    std::chrono::milliseconds previous;
+};
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+#include <stdexcept>
+#include "session_id.hpp"
+#include "signing_session.hpp"
+#include "timing_wheel.hpp"
+
+// Parses "90", "90s", "15m", "24h" or "7d" into seconds; -1 if malformed
+inline int64_t parse_duration_seconds(const std::string& text) {
+    if (text.empty()) return -1;
+    char* end = nullptr;
+    long long value = std::strtoll(text.c_str(), &end, 10);
+    if (end == text.c_str() || value < 0) return -1;
+
+    std::string unit(end);
+    if (unit.empty() || unit == "s") return value;
+    if (unit == "m") return value * 60;
+    if (unit == "h") return value * 3600;
+    if (unit == "d") return value * 86400;
+    return -1;
+}
+
+// Per-status session lifetimes, enforced with a timing wheel on one-second ticks.
+// Each status change restarts the clock with that status's TTL. Expired IDs are
+// handed to the callback in batches from a background thread.
+class SessionExpiry {
+public:
+    using ExpireCallback = std::function<void(const std::vector<SessionId>&)>;
+
+    // TTLs come from SESSION_TTL_<STATUS> (e.g. SESSION_TTL_PENDING=24h), with
+    // SESSION_TTL_DEFAULT for statuses without their own setting. 0 = never expire.
+    SessionExpiry(ExpireCallback on_expire)
+        : on_expire(std::move(on_expire)), wheel(now_tick()) {
+        int64_t default_ttl = 7 * 24 * 3600;
+        load_ttl("SESSION_TTL_DEFAULT", default_ttl);
+        ttl_by_status.fill(default_ttl);
+        ttl_by_status[static_cast<size_t>(SessionStatus::Pending)] = 24 * 3600;
+
+        for (size_t i = 0; i < session_status_count; i++) {
+            std::string name = std::string("SESSION_TTL_") + to_string(static_cast<SessionStatus>(i));
+            for (auto& c : name) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            load_ttl(name, ttl_by_status[i]);
+        }
+    }
+
+    ~SessionExpiry() { stop(); }
+
+    void start() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running) return;
+        running = true;
+        worker = std::thread([this] { run(); });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wakeup.notify_all();
+        if (worker.joinable()) worker.join();
+    }
+
+    // (Re)arms the session's timer for the TTL of `status`, less `age_seconds`
+    // already spent in it (used when restoring sessions after a restart)
+    void schedule(const SessionId& id, SessionStatus status, int64_t age_seconds = 0) {
+        int64_t ttl = ttl_for(status);
+        if (ttl != 0) ttl = std::max<int64_t>(ttl - age_seconds, 1);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = timers.find(id);
+        if (it != timers.end()) {
+            wheel.cancel(it->second);
+            if (ttl == 0) {
+                timers.erase(it);
+                return;
+            }
+            it->second = wheel.schedule(id, now_tick() + ttl);
+        } else if (ttl != 0) {
+            timers.emplace(id, wheel.schedule(id, now_tick() + ttl));
+        }
+    }
+
+    void cancel(const SessionId& id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = timers.find(id);
+        if (it == timers.end()) return;
+        wheel.cancel(it->second);
+        timers.erase(it);
+    }
+
+    int64_t ttl_for(SessionStatus status) const {
+        return ttl_by_status[static_cast<size_t>(status)];
+    }
+
+    size_t pending_timers() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return wheel.size();
+    }
+
+private:
+    static constexpr size_t batch_size = 1024;
+
+    ExpireCallback on_expire;
+    std::array<int64_t, session_status_count> ttl_by_status;
+
+    TimingWheel<SessionId> wheel;
+    std::unordered_map<SessionId, TimingWheel<SessionId>::Handle, SessionIdHash> timers;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool running = false;
+    std::thread worker;
+
+    static uint64_t now_tick() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void load_ttl(const std::string& env_name, int64_t& ttl) {
+        const char* value = std::getenv(env_name.c_str());
+        if (!value) return;
+        int64_t parsed = parse_duration_seconds(value);
+        if (parsed < 0) {
+            throw std::runtime_error("Invalid " + env_name + " value: " + value);
+        }
+        ttl = parsed;
+    }
+
+    void run() {
+        std::vector<SessionId> expired;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running) {
+            wakeup.wait_for(lock, std::chrono::seconds(1), [this] { return !running; });
+            if (!running) break;
+
+            expired.clear();
+            wheel.advance(now_tick(), expired);
+            if (expired.empty()) continue;
+            for (const auto& id : expired) timers.erase(id);
+
+            // Clean up outside the lock so handlers can keep (re)scheduling
+            lock.unlock();
+            for (size_t i = 0; i < expired.size(); i += batch_size) {
+                auto first = expired.begin() + i;
+                auto last = expired.begin() + std::min(i + batch_size, expired.size());
+                on_expire(std::vector<SessionId>(first, last));
+            }
+            lock.lock();
+        }
+    }
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <openssl/rand.h>
+
+// 128-bit random session identifier, stored inline (no heap allocation) and
+// rendered as 32 lowercase hex characters in URLs and JSON.
+struct SessionId {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    static constexpr size_t text_length = 32;
+
+    // Draws from a per-thread buffer filled by OpenSSL's CSPRNG. OpenSSL 3 keeps
+    // a DRBG per thread as well, so concurrent handlers never share state or locks;
+    // one RAND_bytes call serves 256 IDs.
+    static SessionId generate() {
+        constexpr size_t batch = 256;
+        thread_local std::array<uint64_t, batch * 2> pool;
+        thread_local size_t next = pool.size();
+
+        if (next == pool.size()) {
+            if (RAND_bytes(reinterpret_cast<unsigned char*>(pool.data()),
+                           static_cast<int>(sizeof(pool))) != 1) {
+                throw std::runtime_error("CSPRNG failure while generating session ID");
+            }
+            next = 0;
+        }
+        SessionId id;
+        id.hi = pool[next++];
+        id.lo = pool[next++];
+        return id;
+    }
+
+    std::array<char, text_length> to_chars() const {
+        static const char* hex = "0123456789abcdef";
+        std::array<char, text_length> out;
+        for (int i = 0; i < 16; i++) {
+            out[i] = hex[(hi >> (60 - 4 * i)) & 0xf];
+            out[16 + i] = hex[(lo >> (60 - 4 * i)) & 0xf];
+        }
+        return out;
+    }
+
+    std::string str() const {
+        auto chars = to_chars();
+        return std::string(chars.data(), chars.size());
+    }
+
+    static std::optional<SessionId> parse(std::string_view text) {
+        if (text.size() != text_length) return std::nullopt;
+        SessionId id;
+        for (size_t i = 0; i < text_length; i++) {
+            char c = text[i];
+            uint64_t v;
+            if (c >= '0' && c <= '9') v = c - '0';
+            else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+            else return std::nullopt;
+            uint64_t& word = (i < 16) ? id.hi : id.lo;
+            word = (word << 4) | v;
+        }
+        return id;
+    }
+
+    bool operator==(const SessionId& other) const { return hi == other.hi && lo == other.lo; }
+    bool operator!=(const SessionId& other) const { return !(*this == other); }
+    bool operator<(const SessionId& other) const {
+        return hi != other.hi ? hi < other.hi : lo < other.lo;
+    }
+};
+
+// IDs are uniformly random already, so folding the halves is a perfect hash
+struct SessionIdHash {
+    size_t operator()(const SessionId& id) const noexcept {
+        return static_cast<size_t>(id.hi ^ id.lo);
+    }
+};
@@ -0,0 +1,356 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "session_id.hpp"
+#include "signing_session.hpp"
+
+// FNV-1a: stable across builds (unlike std::hash), so it can live on disk
+inline uint64_t fnv1a_64(std::string_view text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+inline bool write_fully(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// Snapshot file format, version 2. Everything is addressed by offsets from
+// the start of the file (position independent), 8-byte aligned and in host
+// byte order, so the file is queried in place through mmap:
+//
+//   Header        magic, version, byte-order mark, section table, header CRC
+//   Records       fixed-size records sorted by session ID (binary search)
+//   Fields        the packed field blocks the records point into
+//   ByCreated     record numbers ordered by (created_at, id)
+//   ByStatus[s]   the same, per status
+//   By*Id/Email   (FNV-1a hash, record number) pairs sorted by hash
+namespace snapshot_format {
+
+constexpr char magic[8] = {'S', 'E', 'S', 'S', 'N', 'A', 'P', '2'};
+constexpr uint32_t version = 2;
+constexpr uint32_t byte_order_mark = 0x01020304;
+
+enum Section : uint32_t {
+    Records, Fields, ByCreated, ByPending, BySigned, ByRequestId, BySignatureId, ByEmail, section_count
+};
+static_assert(session_status_count == 2, "one ordered section per status");
+
+struct SectionRef {
+    uint64_t offset;
+    uint64_t count;  // elements (bytes for Fields)
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t file_size;
+    SectionRef sections[section_count];
+    uint32_t header_crc;  // FNV-1a of the header with this field zeroed, folded to 32 bits
+    uint32_t reserved;
+};
+
+struct Record {
+    uint64_t id_hi;
+    uint64_t id_lo;
+    uint64_t fields_offset;  // into the Fields section
+    uint32_t fields_size;
+    uint32_t created_at;
+    uint8_t status;
+    uint8_t provider;     // 0 in snapshots written before provider routing
+    uint8_t reserved[6];
+};
+static_assert(sizeof(Record) == 40, "snapshot record layout is part of the format");
+
+struct HashEntry {
+    uint64_t hash;
+    uint32_t record;
+    uint32_t reserved;
+};
+
+inline size_t element_size(Section section) {
+    switch (section) {
+        case Records: return sizeof(Record);
+        case Fields: return 1;
+        case ByRequestId: case BySignatureId: case ByEmail: return sizeof(HashEntry);
+        default: return sizeof(uint32_t);
+    }
+}
+
+inline uint32_t header_checksum(Header header) {
+    header.header_crc = 0;
+    uint64_t hash = fnv1a_64(std::string_view(reinterpret_cast<const char*>(&header), sizeof(header)));
+    return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+inline bool is_snapshot(std::string_view prefix) {
+    return prefix.size() >= sizeof(magic) && std::memcmp(prefix.data(), magic, sizeof(magic)) == 0;
+}
+
+}  // namespace snapshot_format
+
+// Accumulates sessions and writes them out as a version 2 snapshot
+class SnapshotBuilder {
+public:
+    void add(const SessionRecordRef& session) {
+        snapshot_format::Record record{};
+        record.id_hi = session.id.hi;
+        record.id_lo = session.id.lo;
+        record.fields_offset = fields.size();
+        record.fields_size = static_cast<uint32_t>(session.fields.size());
+        record.created_at = session.created_at;
+        record.status = static_cast<uint8_t>(session.status);
+        record.provider = session.provider;
+        records.push_back(record);
+        fields.append(session.fields.bytes());
+    }
+
+    size_t size() const { return records.size(); }
+
+    // Sorts, builds the indexes and writes the file; false on an I/O error
+    bool write(int fd) {
+        using namespace snapshot_format;
+        std::sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+            return SessionId{a.id_hi, a.id_lo} < SessionId{b.id_hi, b.id_lo};
+        });
+        const uint32_t count = static_cast<uint32_t>(records.size());
+
+        std::vector<uint32_t> by_created(count);
+        std::iota(by_created.begin(), by_created.end(), 0);
+        std::sort(by_created.begin(), by_created.end(), [this](uint32_t a, uint32_t b) {
+            if (records[a].created_at != records[b].created_at) return records[a].created_at < records[b].created_at;
+            return a < b;  // records are in ID order
+        });
+        std::vector<uint32_t> by_status[session_status_count];
+        for (uint32_t i : by_created) by_status[records[i].status].push_back(i);
+
+        std::vector<HashEntry> by_hash[3];
+        const PackedFields::Field hashed[3] = {
+            PackedFields::RequestId, PackedFields::SignatureId, PackedFields::SignerEmail
+        };
+        for (uint32_t i = 0; i < count; i++) {
+            PackedFields record_fields(fields.data() + records[i].fields_offset);
+            for (int h = 0; h < 3; h++) {
+                std::string_view value = record_fields.get(hashed[h]);
+                if (value.empty()) continue;
+                uint64_t hash = hashed[h] == PackedFields::SignerEmail
+                    ? fnv1a_64(normalize_email(value)) : fnv1a_64(value);
+                by_hash[h].push_back({hash, i, 0});
+            }
+        }
+        for (auto& index : by_hash) {
+            std::sort(index.begin(), index.end(), [](const HashEntry& a, const HashEntry& b) {
+                return a.hash != b.hash ? a.hash < b.hash : a.record < b.record;
+            });
+        }
+
+        const std::pair<const void*, size_t> payload[section_count] = {
+            {records.data(), records.size()},
+            {fields.data(), fields.size()},
+            {by_created.data(), by_created.size()},
+            {by_status[0].data(), by_status[0].size()},
+            {by_status[1].data(), by_status[1].size()},
+            {by_hash[0].data(), by_hash[0].size()},
+            {by_hash[1].data(), by_hash[1].size()},
+            {by_hash[2].data(), by_hash[2].size()},
+        };
+
+        Header header{};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = version;
+        header.byte_order = byte_order_mark;
+        uint64_t offset = aligned(sizeof(Header));
+        for (uint32_t s = 0; s < section_count; s++) {
+            header.sections[s] = {offset, payload[s].second};
+            offset = aligned(offset + payload[s].second * element_size(static_cast<Section>(s)));
+        }
+        header.file_size = offset;
+        header.header_crc = header_checksum(header);
+
+        if (!write_fully(fd, reinterpret_cast<const char*>(&header), sizeof(header))) return false;
+        uint64_t written = sizeof(header);
+        static const char zeros[8] = {};
+        for (uint32_t s = 0; s < section_count; s++) {
+            if (!write_fully(fd, zeros, header.sections[s].offset - written)) return false;
+            size_t bytes = payload[s].second * element_size(static_cast<Section>(s));
+            if (!write_fully(fd, static_cast<const char*>(payload[s].first), bytes)) return false;
+            written = header.sections[s].offset + bytes;
+        }
+        return write_fully(fd, zeros, header.file_size - written);
+    }
+
+private:
+    std::vector<snapshot_format::Record> records;
+    std::string fields;
+
+    static uint64_t aligned(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+};
+
+// A version 2 snapshot mapped read-only and queried in place. Opening checks
+// only the header and that every section lies inside the file, so it touches
+// one page however many sessions the file holds; a record is checked when it
+// is read (record numbers from the indexes, its status and its field block),
+// and a bad one throws. Pages are only read from disk as they are touched.
+class MappedSnapshot {
+public:
+    struct Ordered {
+        const uint32_t* data;
+        size_t size;
+        size_t records;
+
+        // The record number at `pos`, checked against the record count
+        uint32_t operator[](size_t pos) const {
+            if (data[pos] >= records) throw std::runtime_error("Corrupt session snapshot index " + std::to_string(data[pos]));
+            return data[pos];
+        }
+    };
+
+    // Throws std::runtime_error if the file is missing, truncated or malformed
+    static std::shared_ptr<const MappedSnapshot> open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(snapshot_format::Header)) {
+            ::close(fd);
+            throw std::runtime_error("Truncated session snapshot " + path);
+        }
+        size_t length = static_cast<size_t>(info.st_size);
+        void* map = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) throw std::runtime_error("Cannot map " + path + ": " + std::strerror(errno));
+
+        std::shared_ptr<MappedSnapshot> snapshot(new MappedSnapshot(static_cast<const char*>(map), length));
+        if (!snapshot->check_header()) throw std::runtime_error("Corrupt session snapshot " + path);
+        return snapshot;
+    }
+
+    ~MappedSnapshot() { ::munmap(const_cast<char*>(base), length); }
+
+    MappedSnapshot(const MappedSnapshot&) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+    size_t size() const { return count; }
+
+    SessionRecordRef record(uint32_t i) const {
+        const auto& r = at(i);
+        if (r.status >= session_status_count ||
+            r.fields_offset > fields_size || r.fields_size > fields_size - r.fields_offset ||
+            (r.fields_size && !PackedFields::valid(std::string_view(fields + r.fields_offset, r.fields_size)))) {
+            throw std::runtime_error("Corrupt session snapshot record " + std::to_string(i));
+        }
+        return {SessionId{r.id_hi, r.id_lo}, r.created_at, static_cast<SessionStatus>(r.status),
+                PackedFields(r.fields_size ? fields + r.fields_offset : nullptr), r.provider};
+    }
+
+    SessionId id(uint32_t i) const { return SessionId{at(i).id_hi, at(i).id_lo}; }
+    uint32_t created_at(uint32_t i) const { return at(i).created_at; }
+
+    std::optional<uint32_t> find(const SessionId& id) const {
+        auto it = std::lower_bound(records, records + count, id,
+            [](const snapshot_format::Record& r, const SessionId& key) {
+                return SessionId{r.id_hi, r.id_lo} < key;
+            });
+        if (it == records + count || SessionId{it->id_hi, it->id_lo} != id) return std::nullopt;
+        return static_cast<uint32_t>(it - records);
+    }
+
+    // Record numbers in (created_at, id) order, overall or for one status
+    Ordered ordered(std::optional<SessionStatus> status) const {
+        auto section = status ? static_cast<snapshot_format::Section>(snapshot_format::ByPending + static_cast<uint32_t>(*status))
+                              : snapshot_format::ByCreated;
+        return {section_data<uint32_t>(section), header().sections[section].count, count};
+    }
+
+    // Calls visit(record number) for each record whose field hashes like `value`;
+    // callers compare the field itself to rule out collisions
+    template <typename Visit>
+    void for_each_candidate(PackedFields::Field field, std::string_view value, Visit&& visit) const {
+        using namespace snapshot_format;
+        Section section = field == PackedFields::RequestId ? ByRequestId
+                        : field == PackedFields::SignatureId ? BySignatureId : ByEmail;
+        uint64_t hash = section == ByEmail ? fnv1a_64(normalize_email(value)) : fnv1a_64(value);
+        const HashEntry* begin = section_data<HashEntry>(section);
+        const HashEntry* end = begin + header().sections[section].count;
+        auto it = std::lower_bound(begin, end, hash,
+            [](const HashEntry& entry, uint64_t key) { return entry.hash < key; });
+        for (; it != end && it->hash == hash; ++it) {
+            at(it->record);  // throws on an out-of-range record number
+            visit(it->record);
+        }
+    }
+
+private:
+    const char* base;
+    size_t length;
+    const snapshot_format::Record* records = nullptr;
+    const char* fields = nullptr;
+    uint64_t fields_size = 0;
+    size_t count = 0;
+
+    MappedSnapshot(const char* base, size_t length) : base(base), length(length) {}
+
+    const snapshot_format::Header& header() const {
+        return *reinterpret_cast<const snapshot_format::Header*>(base);
+    }
+
+    // Record numbers come from the file's indexes, so they are checked too
+    const snapshot_format::Record& at(uint32_t i) const {
+        if (i >= count) throw std::runtime_error("Corrupt session snapshot index " + std::to_string(i));
+        return records[i];
+    }
+
+    template <typename T>
+    const T* section_data(snapshot_format::Section section) const {
+        return reinterpret_cast<const T*>(base + header().sections[section].offset);
+    }
+
+    bool check_header() {
+        using namespace snapshot_format;
+        const Header& h = header();
+        if (std::memcmp(h.magic, magic, sizeof(magic)) != 0 || h.version != version ||
+            h.byte_order != byte_order_mark || h.file_size != length ||
+            h.header_crc != header_checksum(h)) {
+            return false;
+        }
+        for (uint32_t s = 0; s < section_count; s++) {
+            const SectionRef& section = h.sections[s];
+            if (section.offset % 8 != 0 || section.offset > length ||
+                section.count > (length - section.offset) / element_size(static_cast<Section>(s))) {
+                return false;
+            }
+        }
+
+        records = section_data<Record>(Records);
+        fields = section_data<char>(Fields);
+        count = h.sections[Records].count;
+        fields_size = h.sections[Fields].count;
+        return count <= UINT32_MAX;
+    }
+};
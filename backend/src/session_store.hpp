@@ -0,0 +1,445 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <set>
+#include <unordered_map>
+#include <optional>
+#include <shared_mutex>
+#include <mutex>
+#include <limits>
+#include <algorithm>
+#include "session_id.hpp"
+#include "signing_session.hpp"
+#include "session_snapshot.hpp"
+
+// Filters for a listing page. Results are ordered by (created_at, id).
+struct SessionQuery {
+    size_t limit = 100;
+    std::optional<SessionStatus> status;                         // unset = any
+    int64_t created_from = std::numeric_limits<int64_t>::min();  // Unix seconds, inclusive
+    int64_t created_to = std::numeric_limits<int64_t>::max();    // Unix seconds, inclusive
+    std::string after;                                           // cursor from a previous page
+};
+
+struct SessionPage {
+    std::vector<SigningSession> sessions;
+    std::string next_cursor;  // empty when there are no more results
+};
+
+// Sees every mutation, in commit order, while the store's write lock is held.
+// Implementations must not block (buffer the change and return).
+class SessionJournal {
+public:
+    virtual ~SessionJournal() = default;
+    virtual void on_insert(const SigningSession& session) = 0;
+    virtual void on_status(const SessionId& id, SessionStatus status) = 0;
+    virtual void on_erase(const SessionId& id) = 0;
+};
+
+// Thread-safe session map with secondary indexes:
+//  - ordered (created_at, id) indexes for listing, overall and per status
+//  - hash indexes from provider IDs and signer email back to session IDs
+// All indexes are updated under the same lock as the primary map, so a reader
+// never sees a session in one and not the other. Readers share the lock; a
+// listing page costs O(log N + limit) under it, provider lookups O(1).
+//
+// After a restart the store can sit on top of a mapped snapshot (the base),
+// which already carries all of these indexes. Reads consult the in-memory
+// overlay first and then the base; the first write to a base session copies
+// it into the overlay and marks the base entry dead, so nothing is loaded up
+// front.
+class SessionStore {
+private:
+    struct OrderKey {
+        uint32_t created_at;
+        SessionId id;
+        bool operator<(const OrderKey& other) const {
+            if (created_at != other.created_at) return created_at < other.created_at;
+            return id < other.id;
+        }
+    };
+    using OrderedIndex = std::set<OrderKey>;
+
+    std::unordered_map<SessionId, SigningSession, SessionIdHash> sessions;
+    OrderedIndex by_created;
+    std::array<OrderedIndex, session_status_count> by_status;
+    // Keys view into the packed fields of the session they map to, so an entry
+    // is only ever erased together with (or repointed away from) that session
+    std::unordered_map<std::string_view, SessionId> by_signature_request_id;
+    std::unordered_map<std::string_view, SessionId> by_signature_id;
+    // Keyed by a hash of the normalized address; candidates are re-checked on lookup
+    std::unordered_multimap<size_t, SessionId> by_email_hash;
+    SessionJournal* journal = nullptr;
+    mutable std::shared_mutex mutex;
+
+    std::shared_ptr<const MappedSnapshot> base;
+    std::vector<bool> base_dead;  // copied out or erased
+    size_t base_live = 0;
+
+    // Record number of a live base session
+    std::optional<uint32_t> find_base_locked(const SessionId& id) const {
+        if (!base) return std::nullopt;
+        auto i = base->find(id);
+        if (!i || base_dead[*i]) return std::nullopt;
+        return i;
+    }
+
+    // Looks a provider ID up in the overlay, then in the base
+    std::optional<SigningSession> find_by_field_locked(
+        const std::unordered_map<std::string_view, SessionId>& index,
+        PackedFields::Field field, std::string_view value) const {
+        auto it = index.find(value);
+        if (it != index.end()) return sessions.at(it->second);
+        if (!base) return std::nullopt;
+
+        std::optional<SigningSession> found;
+        base->for_each_candidate(field, value, [&](uint32_t i) {
+            if (!found && !base_dead[i] && base->record(i).fields.get(field) == value) {
+                found = SigningSession::from_ref(base->record(i));
+            }
+        });
+        return found;
+    }
+
+    void kill_base_locked(uint32_t i) {
+        base_dead[i] = true;
+        base_live--;
+    }
+
+    OrderedIndex& status_index(SessionStatus status) {
+        return by_status[static_cast<size_t>(status)];
+    }
+
+    static std::string make_cursor(const OrderKey& key) {
+        return std::to_string(key.created_at) + "-" + key.id.str();
+    }
+
+    static bool parse_cursor(const std::string& cursor, OrderKey& key) {
+        size_t dash = cursor.find('-');
+        if (dash == std::string::npos) return false;
+        try {
+            unsigned long long created = std::stoull(cursor.substr(0, dash));
+            if (created > UINT32_MAX) return false;
+            key.created_at = static_cast<uint32_t>(created);
+        } catch (...) {
+            return false;
+        }
+        auto id = SessionId::parse(std::string_view(cursor).substr(dash + 1));
+        if (!id) return false;
+        key.id = *id;
+        return true;
+    }
+
+    // Points a provider ID at the session that owns `value`. When another
+    // session already holds the ID, the key is replaced too: the old one views
+    // into that session's fields and would dangle once it is erased.
+    static void point_locked(std::unordered_map<std::string_view, SessionId>& index,
+                             std::string_view value, const SessionId& id) {
+        auto [it, inserted] = index.try_emplace(value, id);
+        if (inserted) return;
+        index.erase(it);
+        index.emplace(value, id);
+    }
+
+    void index_locked(const SigningSession& session) {
+        OrderKey key{session.created_at, session.id};
+        by_created.insert(key);
+        status_index(session.status).insert(key);
+        if (!session.signature_request_id().empty()) {
+            point_locked(by_signature_request_id, session.signature_request_id(), session.id);
+        }
+        if (!session.signature_id().empty()) {
+            point_locked(by_signature_id, session.signature_id(), session.id);
+        }
+        if (!session.signer_email().empty()) {
+            by_email_hash.emplace(std::hash<std::string>{}(normalize_email(session.signer_email())),
+                                  session.id);
+        }
+    }
+
+    void unindex_locked(const SigningSession& session) {
+        OrderKey key{session.created_at, session.id};
+        by_created.erase(key);
+        status_index(session.status).erase(key);
+
+        auto request_it = by_signature_request_id.find(session.signature_request_id());
+        if (request_it != by_signature_request_id.end() && request_it->second == session.id) {
+            by_signature_request_id.erase(request_it);
+        }
+        auto signature_it = by_signature_id.find(session.signature_id());
+        if (signature_it != by_signature_id.end() && signature_it->second == session.id) {
+            by_signature_id.erase(signature_it);
+        }
+
+        if (!session.signer_email().empty()) {
+            auto range = by_email_hash.equal_range(
+                std::hash<std::string>{}(normalize_email(session.signer_email())));
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == session.id) {
+                    by_email_hash.erase(it);
+                    break;
+                }
+            }
+        }
+    }
+
+public:
+    // Serves the sessions in `snapshot` without loading them. Only valid on an
+    // empty store (i.e. at startup, before replaying the log on top).
+    void attach_base(std::shared_ptr<const MappedSnapshot> snapshot) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        if (!sessions.empty() || base) throw std::logic_error("attach_base needs an empty store");
+        base = std::move(snapshot);
+        base_dead.assign(base->size(), false);
+        base_live = base->size();
+    }
+
+    // Attaches (or with nullptr detaches) the journal that records mutations
+    void set_journal(SessionJournal* new_journal) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        journal = new_journal;
+    }
+
+    // Returns false (and leaves the store untouched) if the ID is already taken
+    bool insert(SigningSession session) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        SessionId id = session.id;
+        if (find_base_locked(id)) return false;
+        auto [it, inserted] = sessions.emplace(id, std::move(session));
+        if (!inserted) return false;
+        index_locked(it->second);
+        if (journal) journal->on_insert(it->second);
+        return true;
+    }
+
+    std::optional<SigningSession> find(const SessionId& id) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = sessions.find(id);
+        if (it != sessions.end()) return it->second;
+        if (auto i = find_base_locked(id)) return SigningSession::from_ref(base->record(*i));
+        return std::nullopt;
+    }
+
+    std::optional<SigningSession> find_by_signature_request_id(std::string_view request_id) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return find_by_field_locked(by_signature_request_id, PackedFields::RequestId, request_id);
+    }
+
+    std::optional<SigningSession> find_by_signature_id(std::string_view signature_id) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return find_by_field_locked(by_signature_id, PackedFields::SignatureId, signature_id);
+    }
+
+    std::vector<SigningSession> find_by_signer_email(std::string_view email) const {
+        std::vector<SigningSession> result;
+        const std::string wanted = normalize_email(email);
+
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto range = by_email_hash.equal_range(std::hash<std::string>{}(wanted));
+        for (auto it = range.first; it != range.second; ++it) {
+            const auto& session = sessions.at(it->second);
+            if (normalize_email(session.signer_email()) == wanted) result.push_back(session);
+        }
+        if (base) {
+            base->for_each_candidate(PackedFields::SignerEmail, wanted, [&](uint32_t i) {
+                auto record = base->record(i);
+                if (!base_dead[i] && normalize_email(record.fields.get(PackedFields::SignerEmail)) == wanted) {
+                    result.push_back(SigningSession::from_ref(record));
+                }
+            });
+        }
+        return result;
+    }
+
+    bool update_status(const SessionId& id, SessionStatus status) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto it = sessions.find(id);
+        if (it == sessions.end()) {
+            // Copy-on-write out of the base
+            auto i = find_base_locked(id);
+            if (!i) return false;
+            if (base->record(*i).status == status) return true;
+            SigningSession session = SigningSession::from_ref(base->record(*i));
+            session.status = status;
+            kill_base_locked(*i);
+            it = sessions.emplace(id, std::move(session)).first;
+            index_locked(it->second);
+            if (journal) journal->on_status(id, status);
+            return true;
+        }
+        if (it->second.status == status) return true;
+
+        OrderKey key{it->second.created_at, id};
+        status_index(it->second.status).erase(key);
+        status_index(status).insert(key);
+        it->second.status = status;
+        if (journal) journal->on_status(id, status);
+        return true;
+    }
+
+    // Removes sessions and every index entry pointing at them. Takes the write
+    // lock once for the whole batch; returns how many were present.
+    size_t erase(const std::vector<SessionId>& ids) {
+        size_t erased = 0;
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        for (const auto& id : ids) {
+            auto it = sessions.find(id);
+            if (it == sessions.end()) {
+                if (auto i = find_base_locked(id)) {
+                    kill_base_locked(*i);
+                    if (journal) journal->on_erase(id);
+                    erased++;
+                }
+                continue;
+            }
+            unindex_locked(it->second);
+            sessions.erase(it);
+            if (journal) journal->on_erase(id);
+            erased++;
+        }
+        return erased;
+    }
+
+    size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return sessions.size() + base_live;
+    }
+
+    // Visits every session under the shared lock. Writers are held off for the
+    // whole scan, so `on_locked` runs at a point consistent with exactly the
+    // sessions visited (and with the journal, which only hears from writers).
+    // Visitors get a SessionRecordRef, valid only during the call.
+    template <typename OnLocked, typename Visit>
+    void for_each(OnLocked&& on_locked, Visit&& visit) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        on_locked();
+        for (const auto& entry : sessions) visit(entry.second.ref());
+        if (!base) return;
+        for (uint32_t i = 0; i < base->size(); i++) {
+            if (!base_dead[i]) visit(base->record(i));
+        }
+    }
+
+    // The store as of one instant: copies of the sessions held in memory, and
+    // the base with the record numbers still live in it. The base is never
+    // written, so its records are read after the lock is released.
+    struct Copy {
+        std::vector<SigningSession> loaded;
+        std::shared_ptr<const MappedSnapshot> base;
+        std::vector<bool> base_dead;
+
+        template <typename Visit>
+        void for_each(Visit&& visit) const {
+            for (const auto& session : loaded) visit(session.ref());
+            if (!base) return;
+            for (uint32_t i = 0; i < base->size(); i++) {
+                if (!base_dead[i]) visit(base->record(i));
+            }
+        }
+    };
+
+    // Like for_each, but holds writers off only while the in-memory sessions
+    // and the base's dead marks are copied
+    template <typename OnLocked>
+    Copy copy(OnLocked&& on_locked) const {
+        Copy result;
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        on_locked();
+        result.loaded.reserve(sessions.size());
+        for (const auto& entry : sessions) result.loaded.push_back(entry.second);
+        result.base = base;
+        result.base_dead = base_dead;
+        return result;
+    }
+
+    // Visits the sessions held in memory (not those still in the base)
+    template <typename Visit>
+    void for_each_loaded(Visit&& visit) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        for (const auto& entry : sessions) visit(entry.second.ref());
+    }
+
+    // Visits live base sessions with record numbers in [begin, end) under the
+    // shared lock, so long scans can go a chunk at a time without holding
+    // writers off. Returns the number of base records.
+    template <typename Visit>
+    size_t for_each_mapped(size_t begin, size_t end, Visit&& visit) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        if (!base) return 0;
+        end = std::min(end, base->size());
+        for (size_t i = begin; i < end; i++) {
+            if (!base_dead[i]) visit(base->record(static_cast<uint32_t>(i)));
+        }
+        return base->size();
+    }
+
+    // Throws std::invalid_argument for a malformed cursor
+    SessionPage list(const SessionQuery& query) const {
+        SessionPage page;
+        OrderKey start{SessionClock::from_unix(query.created_from), SessionId{}};
+        const uint32_t end = SessionClock::from_unix(query.created_to);
+
+        bool have_cursor = false;
+        OrderKey cursor;
+        if (!query.after.empty()) {
+            if (!parse_cursor(query.after, cursor)) {
+                throw std::invalid_argument("Invalid cursor");
+            }
+            have_cursor = true;
+        }
+        if (query.created_to < SessionClock::epoch_unix) return page;
+
+        page.sessions.reserve(query.limit);
+
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        const OrderedIndex& index = query.status
+            ? by_status[static_cast<size_t>(*query.status)]
+            : by_created;
+
+        const bool resume = have_cursor && start < cursor;
+        auto it = resume ? index.upper_bound(cursor) : index.lower_bound(start);
+
+        // Merge with the base's matching order, skipping dead entries
+        MappedSnapshot::Ordered base_order{nullptr, 0, 0};
+        size_t base_pos = 0;
+        auto base_key = [&](size_t pos) {
+            uint32_t i = base_order[pos];
+            return OrderKey{base->created_at(i), base->id(i)};
+        };
+        if (base) {
+            base_order = base->ordered(query.status);
+            const OrderKey& from = resume ? cursor : start;
+            size_t low = 0, high = base_order.size;
+            while (low < high) {
+                size_t mid = (low + high) / 2;
+                OrderKey key = base_key(mid);
+                bool before = resume ? !(from < key) : key < from;
+                if (before) low = mid + 1; else high = mid;
+            }
+            base_pos = low;
+        }
+
+        while (true) {
+            while (base_pos < base_order.size && base_dead[base_order[base_pos]]) base_pos++;
+            bool have_overlay = it != index.end() && it->created_at <= end;
+            bool have_base = base_pos < base_order.size && base_key(base_pos).created_at <= end;
+            if (!have_overlay && !have_base) break;
+
+            if (page.sessions.size() == query.limit) {
+                page.next_cursor = make_cursor(OrderKey{page.sessions.back().created_at,
+                                                        page.sessions.back().id});
+                break;
+            }
+            if (have_base && (!have_overlay || base_key(base_pos) < *it)) {
+                page.sessions.push_back(SigningSession::from_ref(base->record(base_order[base_pos++])));
+            } else {
+                page.sessions.push_back(sessions.at(it->id));
+                ++it;
+            }
+        }
+        return page;
+    }
+};
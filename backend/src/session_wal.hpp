@@ -0,0 +1,523 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <sstream>
+#include <cstdio>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include "session_id.hpp"
+#include "signing_session.hpp"
+#include "session_store.hpp"
+#include "session_snapshot.hpp"
+#include "checksum.hpp"
+
+// Binary encoding of session mutations. Every record is framed as
+// [uint32 payload length][uint32 crc32][payload] (host byte order), so a torn
+// write at the end of a log is detected and dropped on replay.
+namespace wal_record {
+
+enum Type : uint8_t { Insert = 1, Status = 2, Erase = 3 };
+
+template <typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+inline void put_field(std::string& out, std::string_view field) {
+    put(out, static_cast<uint16_t>(field.size()));
+    out.append(field.data(), field.size());
+}
+
+// Appends a framed record whose payload is produced by `body`
+template <typename Body>
+void frame(std::string& out, Body&& body) {
+    size_t header = out.size();
+    out.append(2 * sizeof(uint32_t), '\0');
+    body(out);
+    uint32_t length = static_cast<uint32_t>(out.size() - header - 2 * sizeof(uint32_t));
+    uint32_t crc = crc32_ieee(out.data() + header + 2 * sizeof(uint32_t), length);
+    std::memcpy(&out[header], &length, sizeof(length));
+    std::memcpy(&out[header + sizeof(uint32_t)], &crc, sizeof(crc));
+}
+
+inline void put_id(std::string& out, const SessionId& id) {
+    put(out, id.hi);
+    put(out, id.lo);
+}
+
+inline void encode_insert(std::string& out, const SigningSession& session) {
+    frame(out, [&](std::string& p) {
+        put(p, Insert);
+        put_id(p, session.id);
+        put(p, session.created_at);
+        put(p, session.status);
+        put_field(p, session.signature_request_id());
+        put_field(p, session.signature_id());
+        put_field(p, session.signer_name());
+        put_field(p, session.signer_email());
+        put_field(p, session.signer_phone());
+        put(p, session.provider);
+    });
+}
+
+inline void encode_status(std::string& out, const SessionId& id, SessionStatus status) {
+    frame(out, [&](std::string& p) {
+        put(p, Status);
+        put_id(p, id);
+        put(p, status);
+    });
+}
+
+inline void encode_erase(std::string& out, const SessionId& id) {
+    frame(out, [&](std::string& p) {
+        put(p, Erase);
+        put_id(p, id);
+    });
+}
+
+// Sequential reader over one record payload; any overrun marks it bad
+class Reader {
+public:
+    Reader(const char* data, size_t size) : data(data), size(size) {}
+
+    template <typename T>
+    T get() {
+        T value{};
+        if (!ok || size - pos < sizeof(T)) {
+            ok = false;
+            return value;
+        }
+        std::memcpy(&value, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    std::string_view get_field() {
+        uint16_t length = get<uint16_t>();
+        if (!ok || size - pos < length) {
+            ok = false;
+            return {};
+        }
+        std::string_view field(data + pos, length);
+        pos += length;
+        return field;
+    }
+
+    SessionId get_id() {
+        SessionId id;
+        id.hi = get<uint64_t>();
+        id.lo = get<uint64_t>();
+        return id;
+    }
+
+    bool good() const { return ok && pos == size; }
+    bool at_end() const { return pos == size; }
+
+private:
+    const char* data;
+    size_t size;
+    size_t pos = 0;
+    bool ok = true;
+};
+
+// Applies the framed records in data[0, size) to the store and returns how
+// many bytes formed complete, valid records. Replay stops at the first torn or
+// corrupt record.
+inline size_t apply(const char* data, size_t size, SessionStore& store) {
+    size_t pos = 0;
+    while (size - pos >= 2 * sizeof(uint32_t)) {
+        uint32_t length, crc;
+        std::memcpy(&length, data + pos, sizeof(length));
+        std::memcpy(&crc, data + pos + sizeof(uint32_t), sizeof(crc));
+        const char* payload = data + pos + 2 * sizeof(uint32_t);
+        if (size - pos - 2 * sizeof(uint32_t) < length) break;
+        if (crc32_ieee(payload, length) != crc) break;
+
+        Reader reader(payload, length);
+        auto type = reader.get<uint8_t>();
+        SessionId id = reader.get_id();
+        if (type == Insert) {
+            SigningSession session;
+            session.id = id;
+            session.created_at = reader.get<uint32_t>();
+            session.status = reader.get<SessionStatus>();
+            auto request_id = reader.get_field();
+            auto signature_id = reader.get_field();
+            auto name = reader.get_field();
+            auto email = reader.get_field();
+            auto phone = reader.get_field();
+            session.provider = reader.at_end() ? 0 : reader.get<uint8_t>();  // absent in older logs
+            if (!reader.good() || static_cast<size_t>(session.status) >= session_status_count) break;
+            session.set_fields(request_id, signature_id, name, email, phone);
+            if (!store.insert(session)) {
+                store.erase({id});
+                store.insert(std::move(session));
+            }
+        } else if (type == Status) {
+            auto status = reader.get<SessionStatus>();
+            if (!reader.good() || static_cast<size_t>(status) >= session_status_count) break;
+            store.update_status(id, status);
+        } else if (type == Erase) {
+            if (!reader.good()) break;
+            store.erase({id});
+        } else {
+            break;
+        }
+        pos += 2 * sizeof(uint32_t) + length;
+    }
+    return pos;
+}
+
+}  // namespace wal_record
+
+// Append-only write-ahead log of session mutations with group commit.
+//
+// The store hands every mutation to on_insert/on_status/on_erase under its
+// write lock; those only append to an in-memory buffer. A flusher thread
+// writes whatever has accumulated and fdatasyncs it in one go, so concurrent
+// handlers share a single sync instead of paying one each. Callers that must
+// not acknowledge before the data is on disk call sync(), which waits for the
+// batch containing everything appended so far.
+//
+// The log is split into numbered segments (wal-<n>.log). A snapshot
+// (snapshot-<n>.bin, see session_snapshot.hpp) holds the complete store as of
+// the start of segment n; once it is durable, older segments and snapshots are
+// deleted. Recovery maps the newest snapshot under the store without loading
+// it and replays only the segments from n on.
+class SessionWal : public SessionJournal {
+public:
+    struct Options {
+        size_t snapshot_bytes = 64 * 1024 * 1024;  // log growth that triggers a snapshot
+        int64_t snapshot_interval = 3600;          // seconds; 0 = size trigger only
+    };
+
+    SessionWal(std::string dir, Options options)
+        : dir(std::move(dir)), options(options) {
+        std::error_code ec;
+        std::filesystem::create_directories(this->dir, ec);
+        if (ec) throw std::runtime_error("Cannot create session log directory " + this->dir + ": " + ec.message());
+    }
+
+    ~SessionWal() override { stop(); }
+
+    // Maps the newest snapshot under `store` and replays the log on top. Call
+    // before attaching the journal; returns the number of sessions recovered.
+    size_t recover(SessionStore& store) {
+        uint64_t snapshot_segment = 0;
+        std::vector<uint64_t> segments;
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            const std::string name = entry.path().filename().string();
+            uint64_t n;
+            if (parse_name(name, "snapshot-", ".bin", n)) {
+                snapshot_segment = std::max(snapshot_segment, n);
+            } else if (parse_name(name, "wal-", ".log", n)) {
+                segments.push_back(n);
+            }
+        }
+        std::sort(segments.begin(), segments.end());
+
+        if (snapshot_segment > 0) {
+            std::string path = file_path("snapshot-", snapshot_segment, ".bin");
+            if (snapshot_format::is_snapshot(read_prefix(path, sizeof(snapshot_format::magic)))) {
+                store.attach_base(MappedSnapshot::open(path));
+            } else {
+                load_legacy_snapshot(path, store);
+            }
+        }
+
+        for (uint64_t n : segments) {
+            next_segment = std::max(next_segment, n + 1);
+            if (n < snapshot_segment) continue;
+            std::string path = file_path("wal-", n, ".log");
+            std::string log = read_file(path);
+            size_t valid = wal_record::apply(log.data(), log.size(), store);
+            if (valid != log.size()) {
+                // Torn tail from a crash mid-write: drop it so later segments stay clean
+                std::cerr << "Session log " << path << ": discarding " << (log.size() - valid)
+                          << " trailing bytes" << std::endl;
+                std::filesystem::resize_file(path, valid);
+            }
+            log_bytes += valid;
+        }
+        next_segment = std::max(next_segment, snapshot_segment + 1);
+        return store.size();
+    }
+
+    // Opens a fresh segment, attaches to the store and starts the flusher and
+    // snapshot threads
+    void start(SessionStore& store) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running) return;
+        current_fd = open_segment(next_segment++);
+        this->store = &store;
+        running = true;
+        flusher = std::thread([this] { flush_loop(); });
+        snapshotter = std::thread([this] { snapshot_loop(); });
+        store.set_journal(this);
+    }
+
+    // Detaches from the store and flushes everything still buffered
+    void stop() {
+        if (store) store->set_journal(nullptr);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) return;
+            running = false;
+        }
+        wakeup.notify_all();
+        snapshot_wakeup.notify_all();
+        if (snapshotter.joinable()) snapshotter.join();
+        if (flusher.joinable()) flusher.join();
+        if (current_fd >= 0) ::close(current_fd);
+        current_fd = -1;
+    }
+
+    // Blocks until every record appended so far is on disk. Concurrent callers
+    // share one fdatasync. Throws if the log can no longer be written.
+    void sync() {
+        std::unique_lock<std::mutex> lock(mutex);
+        uint64_t target = appended_seq;
+        durable.wait(lock, [&] { return durable_seq >= target || failed || !running; });
+        if (failed) throw std::runtime_error("Session log write failed");
+    }
+
+    // Writes a snapshot now and prunes the log behind it
+    void snapshot() {
+        std::lock_guard<std::mutex> serialize(snapshot_mutex);
+        uint64_t segment = 0;
+        auto copy = store->copy([&] { segment = rotate(); });
+        SnapshotBuilder builder;
+        copy.for_each([&](const SessionRecordRef& session) { builder.add(session); });
+
+        std::string final_path = file_path("snapshot-", segment, ".bin");
+        std::string temp_path = final_path + ".tmp";
+        int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0) throw std::runtime_error("Cannot write " + temp_path + ": " + std::strerror(errno));
+        bool ok = builder.write(fd) && ::fsync(fd) == 0;
+        ::close(fd);
+        if (!ok || std::rename(temp_path.c_str(), final_path.c_str()) != 0) {
+            std::filesystem::remove(temp_path);
+            throw std::runtime_error("Cannot write " + final_path);
+        }
+        sync_directory();
+
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            const std::string name = entry.path().filename().string();
+            uint64_t n;
+            if ((parse_name(name, "wal-", ".log", n) || parse_name(name, "snapshot-", ".bin", n)) &&
+                n < segment) {
+                std::error_code ec;
+                std::filesystem::remove(entry.path(), ec);
+            }
+        }
+    }
+
+    void on_insert(const SigningSession& session) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        wal_record::encode_insert(pending, session);
+        appended();
+    }
+
+    void on_status(const SessionId& id, SessionStatus status) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        wal_record::encode_status(pending, id, status);
+        appended();
+    }
+
+    void on_erase(const SessionId& id) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        wal_record::encode_erase(pending, id);
+        appended();
+    }
+
+private:
+    // Version 1 snapshots: the magic followed by insert records
+    static constexpr char legacy_snapshot_magic[8] = {'S', 'E', 'S', 'S', 'N', 'A', 'P', '1'};
+
+    // Buffered bytes that belong to a segment that has since been rotated out
+    struct SealedSegment {
+        int fd;
+        std::string bytes;
+    };
+
+    std::string dir;
+    Options options;
+    SessionStore* store = nullptr;
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable durable;
+    std::string pending;
+    std::vector<SealedSegment> sealed;
+    int current_fd = -1;
+    uint64_t next_segment = 1;
+    uint64_t appended_seq = 0;
+    uint64_t durable_seq = 0;
+    size_t log_bytes = 0;  // since the last snapshot
+    bool running = false;
+    bool failed = false;
+    std::thread flusher;
+
+    std::mutex snapshot_mutex;
+    std::condition_variable snapshot_wakeup;
+    std::thread snapshotter;
+
+    void appended() {
+        appended_seq++;
+        wakeup.notify_all();
+    }
+
+    std::string file_path(const char* prefix, uint64_t n, const char* suffix) const {
+        char number[21];
+        std::snprintf(number, sizeof(number), "%020llu", static_cast<unsigned long long>(n));
+        return dir + "/" + prefix + number + suffix;
+    }
+
+    static bool parse_name(const std::string& name, const std::string& prefix,
+                           const std::string& suffix, uint64_t& n) {
+        if (name.size() <= prefix.size() + suffix.size() ||
+            name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            return false;
+        }
+        std::string digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+        if (digits.find_first_not_of("0123456789") != std::string::npos) return false;
+        n = std::stoull(digits);
+        return true;
+    }
+
+    static std::string read_file(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) throw std::runtime_error("Cannot read " + path);
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        return buffer.str();
+    }
+
+    static std::string read_prefix(const std::string& path, size_t size) {
+        std::ifstream file(path, std::ios::binary);
+        std::string prefix(size, '\0');
+        file.read(&prefix[0], size);
+        prefix.resize(static_cast<size_t>(file.gcount()));
+        return prefix;
+    }
+
+    void load_legacy_snapshot(const std::string& path, SessionStore& store) {
+        std::string image = read_file(path);
+        const size_t header = sizeof(legacy_snapshot_magic);
+        if (image.size() < header || std::memcmp(image.data(), legacy_snapshot_magic, header) != 0 ||
+            wal_record::apply(image.data() + header, image.size() - header, store) != image.size() - header) {
+            throw std::runtime_error("Corrupt session snapshot " + path);
+        }
+    }
+
+    void sync_directory() {
+        int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) return;
+        ::fsync(fd);
+        ::close(fd);
+    }
+
+    int open_segment(uint64_t n) {
+        std::string path = file_path("wal-", n, ".log");
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+        if (fd < 0) throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+        sync_directory();
+        return fd;
+    }
+
+    // Starts a new segment; records buffered so far still go to the old one.
+    // Returns the new segment's number.
+    uint64_t rotate() {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t n = next_segment++;
+        int fd = open_segment(n);
+        sealed.push_back({current_fd, std::move(pending)});
+        pending.clear();
+        current_fd = fd;
+        log_bytes = 0;
+        wakeup.notify_all();
+        return n;
+    }
+
+    void flush_loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wakeup.wait(lock, [this] { return !pending.empty() || !sealed.empty() || !running; });
+            if (pending.empty() && sealed.empty() && !running) break;
+
+            // Take the whole batch; new records keep accumulating meanwhile
+            std::vector<SealedSegment> batch = std::move(sealed);
+            sealed.clear();
+            batch.push_back({current_fd, std::move(pending)});
+            pending.clear();
+            uint64_t target = appended_seq;
+            lock.unlock();
+
+            bool ok = true;
+            for (size_t i = 0; i < batch.size(); i++) {
+                auto& segment = batch[i];
+                if (segment.fd < 0) continue;
+                if (!segment.bytes.empty()) {
+                    ok = write_fully(segment.fd, segment.bytes.data(), segment.bytes.size()) &&
+                         ::fdatasync(segment.fd) == 0 && ok;
+                }
+                if (i + 1 < batch.size()) ::close(segment.fd);  // rotated out
+            }
+            size_t bytes = batch.back().bytes.size();
+
+            lock.lock();
+            if (!ok && !failed) {
+                failed = true;
+                std::cerr << "Session log write failed: " << std::strerror(errno) << std::endl;
+            }
+            durable_seq = target;
+            log_bytes += bytes;
+            durable.notify_all();
+        }
+        durable.notify_all();
+    }
+
+    void snapshot_loop() {
+        auto last_snapshot = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running) {
+            snapshot_wakeup.wait_for(lock, std::chrono::seconds(1), [this] { return !running; });
+            if (!running) break;
+
+            bool by_size = log_bytes >= options.snapshot_bytes;
+            bool by_time = options.snapshot_interval > 0 && log_bytes > 0 &&
+                std::chrono::steady_clock::now() - last_snapshot >= std::chrono::seconds(options.snapshot_interval);
+            if (!by_size && !by_time) continue;
+
+            lock.unlock();
+            try {
+                auto start = std::chrono::steady_clock::now();
+                snapshot();
+                std::cout << "Session snapshot written in "
+                          << std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now() - start).count()
+                          << " ms" << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "Session snapshot failed: " << e.what() << std::endl;
+            }
+            last_snapshot = std::chrono::steady_clock::now();
+            lock.lock();
+        }
+    }
+};
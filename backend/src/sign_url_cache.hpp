@@ -0,0 +1,198 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <optional>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <algorithm>
+#include "session_id.hpp"
+
+// Embedded signing URLs per session, kept until shortly before the provider's
+// expiry so opening (or reloading) the signing page needs no provider round
+// trip. A few background workers fetch URLs that are asked for ahead of time
+// (prefetch(), right after a session is created) and refresh those within
+// `refresh_ahead` (or half their lifetime, if that is shorter) of expiring,
+// as long as someone asked for the URL within `keep_warm`; the others are
+// dropped when they run out. `fetch` does the provider call and put()s the
+// result; a failed refresh is retried after `retry_delay`. A caller asking
+// for a URL that a worker is fetching right now waits for it; one that is
+// still queued is taken off the queue and left to the caller, so either way
+// it is fetched once.
+class SignUrlCache {
+public:
+    using Fetch = std::function<void(const SessionId&)>;
+
+    SignUrlCache(Fetch fetch, std::chrono::seconds refresh_ahead, size_t workers = 4, size_t max_entries = 100000)
+        : fetch(std::move(fetch)), refresh_ahead(refresh_ahead), worker_count(workers), max_entries(max_entries) {}
+
+    ~SignUrlCache() { stop(); }
+
+    void start() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running) return;
+        running = true;
+        for (size_t i = 0; i < worker_count; i++) workers.emplace_back([this] { run(); });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wakeup.notify_all();
+        for (auto& worker : workers) {
+            if (worker.joinable()) worker.join();
+        }
+        workers.clear();
+    }
+
+    // The cached URL, if it stays valid long enough for the page to load it,
+    // waiting until `wait_until` for a fetch already in progress. On nullopt
+    // the caller fetches the URL itself (and put()s it).
+    std::optional<std::string> get(const SessionId& id,
+                                   std::chrono::steady_clock::time_point wait_until = {}) {
+        std::unique_lock<std::mutex> lock(mutex);
+        requested[id] = std::time(nullptr);
+        fetched.wait_until(lock, wait_until, [&] { return fetching.count(id) == 0; });
+        auto it = entries.find(id);
+        if (it == entries.end() || it->second.expires_at - min_validity <= std::time(nullptr)) {
+            if (!fetching.count(id)) queued.erase(id);  // not picked up yet: the caller's fetch replaces it
+            return std::nullopt;
+        }
+        return it->second.url;
+    }
+
+    void put(const SessionId& id, std::string url, std::time_t expires_at) {
+        std::time_t now = std::time(nullptr);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (entries.size() >= max_entries && entries.find(id) == entries.end()) {
+            for (auto it = entries.begin(); it != entries.end();) {
+                it = it->second.expires_at <= now ? entries.erase(it) : std::next(it);
+            }
+            if (entries.size() >= max_entries) return;
+        }
+        std::time_t ahead = std::min<std::time_t>(refresh_ahead.count(), (expires_at - now) / 2);
+        entries[id] = Entry{std::move(url), expires_at, expires_at - ahead};
+    }
+
+    // Fetches the session's URL in the background; it counts as asked for
+    void prefetch(const SessionId& id) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) return;
+            requested[id] = std::time(nullptr);
+            if (!enqueue_locked(id)) return;
+        }
+        wakeup.notify_one();
+    }
+
+    void forget(const std::vector<SessionId>& ids) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& id : ids) {
+            entries.erase(id);
+            requested.erase(id);
+        }
+    }
+
+private:
+    static constexpr std::time_t min_validity = 10;  // seconds a handed-out URL must still be good for
+    static constexpr std::time_t retry_delay = 30;
+    static constexpr std::time_t keep_warm = 15 * 60;  // seconds since the last get() that refreshes continue
+    static constexpr std::chrono::seconds scan_interval{5};
+
+    struct Entry {
+        std::string url;
+        std::time_t expires_at;
+        std::time_t refresh_at;  // pushed back after a failed refresh
+    };
+
+    Fetch fetch;
+    std::chrono::seconds refresh_ahead;
+    size_t worker_count;
+    size_t max_entries;
+    std::unordered_map<SessionId, Entry, SessionIdHash> entries;
+    std::unordered_map<SessionId, std::time_t, SessionIdHash> requested;  // last get() or prefetch()
+    std::deque<SessionId> queue;
+    std::unordered_set<SessionId, SessionIdHash> queued;  // waiting or being fetched
+    std::unordered_set<SessionId, SessionIdHash> fetching;
+    std::chrono::steady_clock::time_point next_scan;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable fetched;
+    bool running = false;
+    std::vector<std::thread> workers;
+
+    bool enqueue_locked(const SessionId& id) {
+        if (!queued.insert(id).second) return false;
+        queue.push_back(id);
+        return true;
+    }
+
+    // Queues refreshes for URLs about to expire that were asked for lately,
+    // and drops the expired ones and requests nobody followed up on
+    void scan_locked() {
+        std::time_t now = std::time(nullptr);
+        for (auto it = entries.begin(); it != entries.end();) {
+            const Entry& entry = it->second;
+            if (entry.expires_at <= now) {
+                it = entries.erase(it);
+                continue;
+            }
+            auto asked = requested.find(it->first);
+            if (entry.refresh_at <= now && asked != requested.end() && now - asked->second < keep_warm) {
+                enqueue_locked(it->first);
+            }
+            ++it;
+        }
+        for (auto it = requested.begin(); it != requested.end();) {
+            it = now - it->second >= keep_warm && !entries.count(it->first) ? requested.erase(it) : std::next(it);
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= next_scan) {
+                next_scan = now + scan_interval;
+                scan_locked();
+            }
+            if (queue.empty()) {
+                wakeup.wait_until(lock, next_scan);
+                continue;
+            }
+            SessionId id = queue.front();
+            queue.pop_front();
+            if (!queued.count(id)) continue;  // taken over by get()
+            auto cached = entries.find(id);
+            if (cached != entries.end() && cached->second.refresh_at > std::time(nullptr)) {
+                queued.erase(id);  // fetched on demand meanwhile
+                continue;
+            }
+            fetching.insert(id);
+            lock.unlock();
+            bool ok = true;
+            try {
+                fetch(id);
+            } catch (const std::exception& e) {
+                std::cerr << "Fetching signing URL for " << id.str() << " failed: " << e.what() << std::endl;
+                ok = false;
+            }
+            lock.lock();
+            queued.erase(id);
+            fetching.erase(id);
+            fetched.notify_all();
+            auto it = entries.find(id);
+            if (!ok && it != entries.end()) it->second.refresh_at = std::time(nullptr) + retry_delay;
+        }
+    }
+};
@@ -0,0 +1,768 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <optional>
+#include <condition_variable>
+#include <chrono>
+#include <ctime>
+#include <stdexcept>
+#include "httplib.h"
+#include "json.hpp"
+#include "http_util.hpp"
+#include "client_pool.hpp"
+#include "delayed_executor.hpp"
+#include "provider_error.hpp"
+#include "provider_guard.hpp"
+#include "rate_scheduler.hpp"
+#include "latency_window.hpp"
+#include "request_deadline.hpp"
+#include "retry_policy.hpp"
+#include "signing_session.hpp"
+
+// The e-signature services documents can be sent through. Each provider is a
+// class with the same static interface, and calls are dispatched to it through
+// ProviderRouter, so endpoint paths and response fields are fixed at compile
+// time instead of picked by comparing provider names on every request. A
+// provider supplies:
+//
+//   static constexpr const char* name, host, api_key_env, base_url_env
+//   static constexpr const char* client_id_env     (nullptr when unused)
+//   static constexpr RateScheduler::Limit read_rate, write_rate
+//   static void configure(httplib::SSLClient&, const std::string& api_key)
+//   void authorize(httplib::Headers&) const
+//   ProviderDocument send_with_upload(name, email, phone, pdf_content)
+//   std::string register_template(pdf_content)
+//   ProviderDocument send_with_template(template_id, name, email, phone)
+//   SignUrl sign_url(const SigningSession&)
+//   SessionStatus fetch_status(const SigningSession&)
+//   std::string download(const SigningSession&)
+//
+// and inherits the pooled transport from SignatureProvider<Derived>. Every
+// call is labelled with an endpoint ("create", "status", ...) and goes through
+// that endpoint's ProviderGuard, so one failing endpoint trips its own breaker
+// without blocking the others. Before that it takes a token from the read
+// (GET) or write (POST) RateScheduler, which keeps us under the account's
+// rate limit and lets interactive calls jump ahead of background ones. Calls
+// on the user's critical path (the signing URL) can be hedged: if the first
+// request is slower than the endpoint's usual latency, a copy goes out on
+// another connection and whichever answers first is used. GETs are
+// idempotent, so transient failures (transport errors, 429, 502-504) are
+// retried with jittered backoff while the shared retry budget and the
+// request's deadline allow; creates are never retried, since a lost response
+// may still have created a document. In demo mode every operation returns a
+// canned result without calling out.
+
+struct ProviderDocument {
+    std::string signature_request_id;
+    std::string signature_id;
+};
+
+// An embedded signing URL and when the provider stops accepting it
+struct SignUrl {
+    std::string url;
+    std::time_t expires_at;
+};
+
+struct ProviderOptions {
+    std::string base_url;      // "https://host[:port]" instead of the provider's API host (e.g. a mock)
+    std::string ca_cert_file;  // trust this certificate instead of the system store
+    std::chrono::seconds connect_timeout{5};
+    std::chrono::seconds read_timeout{30};
+    size_t max_idle_connections = 16;  // keep-alive connections kept per provider
+    ProviderGuard::Options guard;
+    unsigned retry_attempts = 3;  // per idempotent call, including the first
+    std::chrono::milliseconds retry_base{100};
+    std::chrono::milliseconds retry_cap{2000};
+    std::shared_ptr<RetryBudget> retry_budget = std::make_shared<RetryBudget>();
+    double hedge_percentile = 95;  // hedge delay as a latency percentile (0 = never hedge)
+    double hedge_ratio = 0.05;     // hedges allowed per hedgeable call
+};
+
+template <typename Derived>
+class SignatureProvider {
+public:
+    SignatureProvider(std::string api_key, std::string client_id, bool demo, ProviderOptions options = {})
+        : api_key(std::move(api_key)), client_id(std::move(client_id)), demo(demo), options(options),
+          read_limit(std::string(Derived::name) + " reads", Derived::read_rate),
+          write_limit(std::string(Derived::name) + " writes", Derived::write_rate),
+          hedge_budget(options.hedge_ratio, 0, 10),
+          clients(base_host(options.base_url), base_port(options.base_url),
+                  [key = this->api_key, options](httplib::SSLClient& cli) {
+              if (!options.ca_cert_file.empty()) cli.set_ca_cert_path(options.ca_cert_file.c_str());
+              cli.set_connection_timeout(options.connect_timeout);
+              cli.set_read_timeout(options.read_timeout);
+              cli.set_write_timeout(options.read_timeout);
+              Derived::configure(cli, key);
+          }, options.max_idle_connections) {}
+
+protected:
+    using json = nlohmann::json;
+
+    std::string api_key;
+    std::string client_id;
+    bool demo;
+    ProviderOptions options;
+    RateScheduler read_limit;
+    RateScheduler write_limit;
+    RetryBudget hedge_budget;
+    ClientPool clients;  // keep-alive connections, one leased per call
+
+    json get_json(const char* endpoint, const std::string& path, bool hedge = false) {
+        // Owns its path: a hedged copy may outlive this call
+        return parse_response(send(endpoint, true, [path](httplib::SSLClient& cli, const httplib::Headers& headers) {
+            return cli.Get(path.c_str(), headers);
+        }, hedge));
+    }
+
+    json post_json(const char* endpoint, const std::string& path, const json& body) {
+        return parse_response(send(endpoint, false, [&](httplib::SSLClient& cli, const httplib::Headers& headers) {
+            return cli.Post(path.c_str(), headers, body.dump(), "application/json");
+        }));
+    }
+
+    json post_form(const char* endpoint, const std::string& path, const httplib::UploadFormDataItems& items) {
+        return parse_response(send(endpoint, false, [&](httplib::SSLClient& cli, const httplib::Headers& headers) {
+            return cli.Post(path.c_str(), headers, items);
+        }));
+    }
+
+    std::string get_file(const char* endpoint, const std::string& path) {
+        auto res = send(endpoint, true, [&](httplib::SSLClient& cli, const httplib::Headers& headers) {
+            return cli.Get(path.c_str(), headers);
+        });
+        if (res && res->status == 200) {
+            return res->body;
+        } else if (res) {
+            throw ProviderError("Failed to download file: Status " + std::to_string(res->status), res->status);
+        } else {
+            throw ProviderError("Failed to download file: Network error", 0);
+        }
+    }
+
+    static json parse_response(const httplib::Result& res) {
+        if (res && (res->status == 200 || res->status == 201)) {
+            return json::parse(res->body);
+        }
+        std::string error_msg = "API call failed: ";
+        if (res) {
+            error_msg += "Status " + std::to_string(res->status);
+            if (!res->body.empty()) error_msg += " - " + res->body;
+        } else {
+            error_msg += "Network error";
+        }
+        throw ProviderError(error_msg, res ? res->status : 0);
+    }
+
+    // How long a signing URL lasts when the provider doesn't say
+    static constexpr std::time_t sign_url_lifetime = 3600;
+
+    // Canned results for demo mode
+    static ProviderDocument demo_document() {
+        return {"demo_request_" + SessionId::generate().str(), "demo_sig_" + SessionId::generate().str()};
+    }
+
+    static std::string demo_template() {
+        return "demo_template_" + SessionId::generate().str();
+    }
+
+    static SignUrl demo_sign_page(const std::string& product) {
+        return {"data:text/html;base64," + base64_encode(
+            "<html><body style='font-family:Arial;text-align:center;padding:50px;'>"
+            "<h1>Demo Signing Interface</h1>"
+            "<p>In a real implementation, this would be the " + product + " embedded signing interface.</p>"
+            "<p>The document would be pre-filled with your information.</p>"
+            "<button onclick='window.parent.postMessage(\"signing_complete\", \"*\")' "
+            "style='padding:10px 20px;font-size:16px;background:#3498db;color:white;border:none;border-radius:5px;cursor:pointer;'>"
+            "Complete Signing (Demo)</button>"
+            "</body></html>"), std::time(nullptr) + sign_url_lifetime};
+    }
+
+    // Every demo document is the sample PDF
+    static std::string demo_download() {
+        std::ifstream file("./backend/sample.pdf", std::ios::binary);
+        if (!file) throw std::runtime_error("Cannot open file: ./backend/sample.pdf");
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+private:
+    using Clock = RequestDeadline::Clock;
+
+    struct Endpoint {
+        ProviderGuard guard;
+        LatencyWindow latency;
+
+        Endpoint(const std::string& name, const ProviderGuard::Options& options) : guard(name, options) {}
+    };
+
+    std::map<std::string, std::unique_ptr<Endpoint>> endpoints;
+    std::mutex endpoints_mutex;
+    DelayedExecutor hedges{2};  // last, so pending hedges end before what they use
+
+    Derived& self() { return static_cast<Derived&>(*this); }
+
+    // Host and port of a base URL ("https://host[:port]"); the provider's
+    // public API without one
+    static std::string base_host(const std::string& base_url) {
+        if (base_url.empty()) return Derived::host;
+        std::string address = authority(base_url);
+        return address.substr(0, address.find(':'));
+    }
+
+    static int base_port(const std::string& base_url) {
+        if (base_url.empty()) return 443;
+        std::string address = authority(base_url);
+        size_t colon = address.find(':');
+        if (colon == std::string::npos) return 443;
+        int port = std::atoi(address.c_str() + colon + 1);
+        if (port <= 0 || port > 65535) {
+            throw std::runtime_error(std::string("Invalid port in ") + Derived::base_url_env + ": " + base_url);
+        }
+        return port;
+    }
+
+    static std::string authority(const std::string& base_url) {
+        const std::string scheme = "https://";
+        if (base_url.compare(0, scheme.size(), scheme) != 0) {
+            throw std::runtime_error(std::string(Derived::base_url_env) + " must be an https:// URL: " + base_url);
+        }
+        std::string rest = base_url.substr(scheme.size());
+        return rest.substr(0, rest.find('/'));
+    }
+
+    Endpoint& endpoint_state(const char* endpoint) {
+        std::lock_guard<std::mutex> lock(endpoints_mutex);
+        auto& slot = endpoints[endpoint];
+        if (!slot) slot = std::make_unique<Endpoint>(std::string(Derived::name) + " " + endpoint, options.guard);
+        return *slot;
+    }
+
+    // Sends one request through the rate limit and the endpoint's guard,
+    // within the request deadline (GETs are reads, everything else a write).
+    // Transport errors, 5xx and 429 count as failures; other responses mean
+    // the provider is up. Retryable requests go again after a backoff (or the
+    // provider's Retry-After) while attempts, budget and deadline allow.
+    template <typename Request>
+    httplib::Result send(const char* endpoint, bool retryable, Request&& request, bool hedge = false) {
+        Endpoint& state = endpoint_state(endpoint);
+        RateScheduler& rate = retryable ? read_limit : write_limit;
+        RetryBackoff backoff(options.retry_base, options.retry_cap);
+        options.retry_budget->record_attempt();
+        if (hedge) hedge_budget.record_attempt();
+        for (unsigned attempt = 1;; attempt++) {
+            auto remaining = RequestDeadline::remaining();
+            if (remaining == Clock::duration::zero()) {
+                throw DeadlineExceeded(std::string(Derived::name) + " " + endpoint + ": request deadline exceeded");
+            }
+            rate.acquire(CallPriorityScope::get(), RequestDeadline::get());
+            auto permit = state.guard.acquire();
+            std::optional<std::chrono::milliseconds> hedge_delay;
+            if (hedge && options.hedge_percentile > 0) hedge_delay = state.latency.percentile(options.hedge_percentile);
+            httplib::Result res = hedge_delay ? race(state, rate, request, *hedge_delay)
+                                              : exchange(state, rate, *clients.lease(), request, authorized());
+            if (!res && RequestDeadline::expired()) {
+                permit.abandon();  // our deadline cut it short, not the provider's fault
+                throw DeadlineExceeded(std::string(Derived::name) + " " + endpoint + ": request deadline exceeded");
+            }
+            permit.finish(answered(res));
+            
+            if (!retryable || attempt >= options.retry_attempts || !transient(res)) return res;
+            std::chrono::milliseconds hint = retry_after(res);
+            if (hint > options.retry_cap) return res;
+            std::chrono::milliseconds delay = std::max(backoff.next(), hint);
+            if (delay >= RequestDeadline::remaining() || !options.retry_budget->try_spend()) return res;
+            std::cerr << "Retrying " << Derived::name << " " << endpoint << " in " << delay.count() << " ms ("
+                      << (res ? "status " + std::to_string(res->status) : httplib::to_string(res.error())) << ")"
+                      << std::endl;
+            std::this_thread::sleep_for(delay);
+        }
+    }
+
+    httplib::Headers authorized() {
+        httplib::Headers headers;
+        self().authorize(headers);
+        return headers;
+    }
+
+    // One request on one connection, with socket timeouts cut to the time the
+    // request has left. A request `cancelled` before it starts isn't sent.
+    template <typename Request>
+    httplib::Result exchange(Endpoint& state, RateScheduler& rate, httplib::SSLClient& cli, const Request& request,
+                             const httplib::Headers& headers, const std::atomic<bool>* cancelled = nullptr) {
+        auto remaining = RequestDeadline::remaining();
+        cli.set_connection_timeout(capped(options.connect_timeout, remaining));
+        cli.set_read_timeout(capped(options.read_timeout, remaining));
+        cli.set_write_timeout(capped(options.read_timeout, remaining));
+        if (cancelled && *cancelled) return httplib::Result(nullptr, httplib::Error::Canceled);
+        auto start = Clock::now();
+        httplib::Result res = request(cli, headers);
+        rate.observe(res);
+        if (answered(res)) state.latency.record(Clock::now() - start);
+        return res;
+    }
+
+    // Runs the request and, if it hasn't answered within `delay`, a copy on a
+    // second connection (when the hedge budget, rate limit and guard allow
+    // one without waiting). The copy is started by the `hedges` executor, so
+    // the usual call that answers in time costs no thread. The first answer
+    // wins and the other request is cancelled. A losing copy finishes on the
+    // executor without being waited for, which is why `request` is copied
+    // and must own what it captures.
+    template <typename Request>
+    httplib::Result race(Endpoint& state, RateScheduler& rate, const Request& request, std::chrono::milliseconds delay) {
+        struct Race {
+            std::mutex mutex;
+            std::condition_variable hedge_finished;
+            httplib::SSLClient* primary = nullptr;  // set while each request is in flight
+            httplib::SSLClient* hedge = nullptr;
+            bool primary_done = false;
+            bool hedge_started = false;  // from here on a failed primary waits for the copy
+            bool hedge_done = false;
+            std::atomic<bool> hedge_cancelled{false};
+            httplib::Result hedge_result;
+        };
+        auto race = std::make_shared<Race>();
+        httplib::Headers headers = authorized();
+        auto primary = clients.lease();
+        race->primary = &*primary;
+        hedges.schedule(Clock::now() + delay, [this, race, &state, &rate, request, headers,
+                                               priority = CallPriorityScope::get(), deadline = RequestDeadline::get()] {
+            std::unique_lock<std::mutex> lock(race->mutex);
+            if (race->primary_done) return;
+            race->hedge_started = true;
+            lock.unlock();
+            auto finish = [&](httplib::Result res) {
+                std::lock_guard<std::mutex> guard(race->mutex);
+                race->hedge_done = true;
+                race->hedge_result = std::move(res);
+                race->hedge_finished.notify_all();
+            };
+            
+            RequestDeadline::Scope scope(deadline);
+            if (!hedge_budget.try_spend() || !rate.try_acquire(priority)) return finish({});
+            lock.lock();
+            bool moot = race->primary_done;
+            lock.unlock();
+            if (moot) return finish({});
+            std::optional<ProviderGuard::Permit> permit;
+            try {
+                permit.emplace(state.guard.acquire());
+            } catch (const ProviderUnavailable&) {
+                return finish({});
+            }
+            auto cli = clients.lease();
+            lock.lock();
+            if (race->primary_done) {
+                lock.unlock();
+                permit->abandon();
+                return finish({});
+            }
+            race->hedge = &*cli;
+            lock.unlock();
+            
+            httplib::Result res = exchange(state, rate, *cli, request, headers, &race->hedge_cancelled);
+            
+            lock.lock();
+            race->hedge = nullptr;
+            if (answered(res)) {
+                if (race->primary) race->primary->stop();
+                permit->finish(true);
+            } else if (res.error() == httplib::Error::Canceled || race->primary_done) {
+                permit->abandon();
+            } else {
+                permit->finish(false);
+            }
+            lock.unlock();
+            finish(std::move(res));
+        });
+        
+        httplib::Result res = exchange(state, rate, *primary, request, headers);
+        std::unique_lock<std::mutex> lock(race->mutex);
+        race->primary_done = true;
+        race->primary = nullptr;
+        if (answered(res)) {
+            race->hedge_cancelled = true;
+            if (race->hedge) race->hedge->stop();
+            return res;
+        }
+        // The original failed; a copy already under way may still answer
+        race->hedge_finished.wait(lock, [&] { return !race->hedge_started || race->hedge_done; });
+        if (answered(race->hedge_result)) return std::move(race->hedge_result);
+        return res;
+    }
+
+    // The provider gave a definitive answer (not a transport error, 5xx or 429)
+    static bool answered(const httplib::Result& res) {
+        return res && res->status < 500 && res->status != 429;
+    }
+
+    static bool transient(const httplib::Result& res) {
+        if (!res) return true;
+        return res->status == 429 || res->status == 502 || res->status == 503 || res->status == 504;
+    }
+
+    // Delay asked for by a Retry-After header in seconds (0 if none)
+    static std::chrono::milliseconds retry_after(const httplib::Result& res) {
+        if (!res || !res->has_header("Retry-After")) return std::chrono::milliseconds(0);
+        std::string value = res->get_header_value("Retry-After");
+        if (value.empty() || !std::all_of(value.begin(), value.end(), ::isdigit)) return std::chrono::milliseconds(0);
+        return std::chrono::seconds(std::strtoll(value.c_str(), nullptr, 10));
+    }
+
+    // A configured socket timeout shortened to the time the request has left
+    static std::chrono::milliseconds capped(std::chrono::seconds configured, RequestDeadline::Clock::duration remaining) {
+        auto timeout = std::min<RequestDeadline::Clock::duration>(configured, remaining);
+        return std::max(std::chrono::milliseconds(1), std::chrono::duration_cast<std::chrono::milliseconds>(timeout));
+    }
+};
+
+class DropboxSignProvider : public SignatureProvider<DropboxSignProvider> {
+public:
+    static constexpr const char* name = "dropbox";
+    static constexpr const char* host = "api.hellosign.com";
+    static constexpr const char* api_key_env = "DROPBOX_SIGN_API_KEY";
+    static constexpr const char* client_id_env = "DROPBOX_SIGN_CLIENT_ID";
+    static constexpr const char* base_url_env = "DROPBOX_SIGN_BASE_URL";
+    // 100 requests a minute; sending and template creation are "higher tier", 25 a minute
+    static constexpr RateScheduler::Limit read_rate{100.0 / 60, 100};
+    static constexpr RateScheduler::Limit write_rate{25.0 / 60, 25};
+
+    using SignatureProvider::SignatureProvider;
+
+    static void configure(httplib::SSLClient& cli, const std::string& api_key) {
+        cli.set_basic_auth(api_key.c_str(), "");
+    }
+
+    void authorize(httplib::Headers&) const {}  // basic auth is set on the client
+
+    ProviderDocument send_with_upload(const std::string& name, const std::string& email,
+                                      const std::string& phone, const std::string& pdf_content) {
+        if (demo) return demo_document();
+
+        json values = {{"name_field", name}, {"email_field", email}, {"phone_field", phone}};
+        httplib::UploadFormDataItems items = {
+            {"test_mode", "1", "", ""},
+            {"client_id", client_id, "", ""},
+            {"subject", "Document for Signing", "", ""},
+            {"message", "Please sign this document", "", ""},
+            {"signers[0][email_address]", email, "", ""},
+            {"signers[0][name]", name, "", ""},
+            {"file[0]", pdf_content, "sample.pdf", "application/pdf"},
+            {"form_fields_per_document", json::array({form_fields(values)}).dump(), "", ""}
+        };
+        return created(post_form("create", "/v3/signature_request/create_embedded", items));
+    }
+
+    std::string register_template(const std::string& pdf_content) {
+        if (demo) return demo_template();
+
+        httplib::UploadFormDataItems items = {
+            {"test_mode", "1", "", ""},
+            {"title", "Document for Signing", "", ""},
+            {"subject", "Document for Signing", "", ""},
+            {"message", "Please sign this document", "", ""},
+            {"signer_roles[0][name]", "Signer", "", ""},
+            {"file[0]", pdf_content, "sample.pdf", "application/pdf"},
+            {"merge_fields", json::array({
+                {{"name", "name_field"}, {"type", "text"}},
+                {{"name", "email_field"}, {"type", "text"}},
+                {{"name", "phone_field"}, {"type", "text"}}
+            }).dump(), "", ""},
+            {"form_fields_per_document", json::array({form_fields()}).dump(), "", ""}
+        };
+        json api_response = post_form("template", "/v3/template/create", items);
+        return api_response["template"]["template_id"];
+    }
+
+    ProviderDocument send_with_template(const std::string& template_id, const std::string& name,
+                                        const std::string& email, const std::string& phone) {
+        if (demo) return demo_document();
+
+        httplib::UploadFormDataItems items = {
+            {"test_mode", "1", "", ""},
+            {"client_id", client_id, "", ""},
+            {"template_ids[0]", template_id, "", ""},
+            {"subject", "Document for Signing", "", ""},
+            {"message", "Please sign this document", "", ""},
+            {"signers[Signer][email_address]", email, "", ""},
+            {"signers[Signer][name]", name, "", ""},
+            {"custom_fields", json::array({
+                {{"name", "name_field"}, {"value", name}},
+                {{"name", "email_field"}, {"value", email}},
+                {{"name", "phone_field"}, {"value", phone}}
+            }).dump(), "", ""}
+        };
+        return created(post_form("create", "/v3/signature_request/create_embedded_with_template", items));
+    }
+
+    SignUrl sign_url(const SigningSession& session) {
+        if (demo) return demo_sign_page("Dropbox Sign");
+
+        json api_response = get_json("sign_url", "/v3/embedded/sign_url/" + std::string(session.signature_id()), true);
+        const json& embedded = api_response["embedded"];
+        std::time_t expires_at = embedded.contains("expires_at") && embedded["expires_at"].is_number_integer()
+                                     ? embedded["expires_at"].get<std::time_t>()
+                                     : std::time(nullptr) + sign_url_lifetime;
+        return {embedded["sign_url"], expires_at};
+    }
+
+    SessionStatus fetch_status(const SigningSession& session) {
+        if (demo) return SessionStatus::Signed;  // demo documents are signed right away
+
+        json api_response = get_json("status", "/v3/signature_request/" + std::string(session.signature_request_id()));
+        bool is_complete = api_response["signature_request"]["is_complete"];
+        return is_complete ? SessionStatus::Signed : SessionStatus::Pending;
+    }
+
+    std::string download(const SigningSession& session) {
+        if (demo) return demo_download();
+
+        return get_file("download", "/v3/signature_request/files/" + std::string(session.signature_request_id()) +
+                        "?file_type=pdf");
+    }
+
+private:
+    // Field layout placed on every document. `values` maps field IDs to
+    // prefilled text; fields without a value are left empty (for templates,
+    // they are filled in when a session is sent).
+    static json form_fields(const json& values = json::object()) {
+        json fields = json::array({
+            {{"api_id", "name_field"}, {"name", "Name"}, {"type", "text"},
+             {"x", 100}, {"y", 200}, {"width", 200}, {"height", 20},
+             {"required", true}, {"signer", 0}, {"page", 1}},
+            {{"api_id", "email_field"}, {"name", "Email"}, {"type", "text"},
+             {"x", 100}, {"y", 250}, {"width", 200}, {"height", 20},
+             {"required", true}, {"signer", 0}, {"page", 1}},
+            {{"api_id", "phone_field"}, {"name", "Phone"}, {"type", "text"},
+             {"x", 100}, {"y", 300}, {"width", 200}, {"height", 20},
+             {"required", true}, {"signer", 0}, {"page", 1}},
+            {{"api_id", "signature_field"}, {"name", "Signature"}, {"type", "signature"},
+             {"x", 100}, {"y", 400}, {"width", 200}, {"height", 60},
+             {"required", true}, {"signer", 0}, {"page", 1}}
+        });
+        for (auto& field : fields) {
+            if (values.contains(field["api_id"])) field["value"] = values[field["api_id"].get<std::string>()];
+        }
+        return fields;
+    }
+
+    static ProviderDocument created(const json& api_response) {
+        return {api_response["signature_request"]["signature_request_id"],
+                api_response["signature_request"]["signatures"][0]["signature_id"]};
+    }
+};
+
+class BoldSignProvider : public SignatureProvider<BoldSignProvider> {
+public:
+    static constexpr const char* name = "boldsign";
+    static constexpr const char* host = "api.boldsign.com";
+    static constexpr const char* api_key_env = "BOLDSIGN_API_KEY";
+    static constexpr const char* client_id_env = nullptr;
+    static constexpr const char* base_url_env = "BOLDSIGN_BASE_URL";
+    // 2000 requests an hour per account, split between reads and writes
+    static constexpr RateScheduler::Limit read_rate{1500.0 / 3600, 100};
+    static constexpr RateScheduler::Limit write_rate{500.0 / 3600, 50};
+
+    using SignatureProvider::SignatureProvider;
+
+    static void configure(httplib::SSLClient&, const std::string&) {}
+
+    void authorize(httplib::Headers& headers) const {
+        headers.emplace("X-API-KEY", api_key);
+    }
+
+    ProviderDocument send_with_upload(const std::string& name, const std::string& email,
+                                      const std::string& phone, const std::string& pdf_content) {
+        if (demo) return created({{"documentId", "demo_doc_" + SessionId::generate().str()}});
+
+        json values = {{"name_field", name}, {"email_field", email}, {"phone_field", phone}};
+        json request_body = {
+            {"title", "Document for Signing"},
+            {"message", "Please sign this document"},
+            {"signers", {{
+                {"name", name},
+                {"emailAddress", email},
+                {"signerOrder", 1},
+                {"signerType", "Signer"},
+                {"formFields", form_fields(values)}
+            }}},
+            {"disableEmails", true},  // For embedded signing
+            {"files", json::array({
+                "data:application/pdf;base64," + base64_encode(pdf_content)
+            })}
+        };
+
+        json api_response = post_json("create", "/v1/document/send", request_body);
+
+        // Log the response for debugging
+        std::cout << "BoldSign create response: " << api_response.dump() << std::endl;
+        return created(api_response);
+    }
+
+    std::string register_template(const std::string& pdf_content) {
+        if (demo) return demo_template();
+
+        json request_body = {
+            {"title", "Document for Signing"},
+            {"documentMessage", "Please sign this document"},
+            {"roles", {{
+                {"name", "Signer"},
+                {"index", 1},
+                {"signerType", "Signer"},
+                {"formFields", form_fields()}
+            }}},
+            {"files", json::array({
+                "data:application/pdf;base64," + base64_encode(pdf_content)
+            })}
+        };
+        json api_response = post_json("template", "/v1/template/create", request_body);
+        if (!api_response.contains("templateId")) {
+            throw std::runtime_error("No templateId in BoldSign response");
+        }
+        return api_response["templateId"];
+    }
+
+    ProviderDocument send_with_template(const std::string& template_id, const std::string& name,
+                                        const std::string& email, const std::string& phone) {
+        if (demo) return created({{"documentId", "demo_doc_" + SessionId::generate().str()}});
+
+        json request_body = {
+            {"title", "Document for Signing"},
+            {"message", "Please sign this document"},
+            {"roles", {{
+                {"roleIndex", 1},
+                {"signerName", name},
+                {"signerEmail", email},
+                {"existingFormFields", {
+                    {{"id", "name_field"}, {"value", name}},
+                    {{"id", "email_field"}, {"value", email}},
+                    {{"id", "phone_field"}, {"value", phone}}
+                }}
+            }}},
+            {"disableEmails", true}
+        };
+        return created(post_json("create", "/v1/template/send?templateId=" + template_id, request_body));
+    }
+
+    SignUrl sign_url(const SigningSession& session) {
+        wait_until_processed(std::string(session.signature_request_id()));
+
+        std::cout << "Getting BoldSign signing URL for document: " << session.signature_request_id() << std::endl;
+        std::cout << "Signer email: " << session.signer_email() << std::endl;
+        if (demo) return demo_sign_page("BoldSign");
+
+        // URL encode the email (dots don't need encoding in query params)
+        std::string encoded_email;
+        for (char c : session.signer_email()) {
+            if (c == '@') {
+                encoded_email += "%40";
+            } else {
+                encoded_email += c;
+            }
+        }
+
+        std::time_t expires_at = std::time(nullptr) + sign_url_lifetime;
+        std::string endpoint = "/v1/document/getEmbeddedSignLink?documentId=" +
+                               std::string(session.signature_request_id()) +
+                               "&signerEmail=" + encoded_email +
+                               "&signLinkValidTill=" + format_iso8601_utc(expires_at);
+        std::cout << "Full endpoint: " << endpoint << std::endl;
+
+        json api_response = get_json("sign_url", endpoint, true);
+
+        // Log the response to debug
+        std::cout << "BoldSign embedded sign link response: " << api_response.dump() << std::endl;
+
+        // BoldSign returns the URL directly in "signLink" field
+        if (!api_response.contains("signLink")) {
+            throw std::runtime_error("No signLink in BoldSign response: " + api_response.dump());
+        }
+        if (api_response["signLink"].is_string()) {
+            return {api_response["signLink"], expires_at};
+        } else if (api_response["signLink"].is_object() && api_response["signLink"].contains("signUrl")) {
+            return {api_response["signLink"]["signUrl"], expires_at};
+        }
+        throw std::runtime_error("Unexpected signLink format in BoldSign response");
+    }
+
+    SessionStatus fetch_status(const SigningSession& session) {
+        if (demo) return SessionStatus::Signed;  // demo documents are signed right away
+
+        json api_response = get_json("status", "/v1/document/properties?documentId=" +
+                                     std::string(session.signature_request_id()));
+        std::string doc_status = api_response["status"];
+        return (doc_status == "Completed") ? SessionStatus::Signed : SessionStatus::Pending;
+    }
+
+    std::string download(const SigningSession& session) {
+        if (demo) return demo_download();
+
+        return get_file("download", "/v1/document/download?documentId=" + std::string(session.signature_request_id()));
+    }
+
+private:
+    // Field layout placed on every document; see DropboxSignProvider::form_fields
+    static json form_fields(const json& values = json::object()) {
+        json fields = json::array({
+            {{"fieldType", "Textbox"}, {"pageNumber", 1},
+             {"bounds", {{"x", 100}, {"y", 200}, {"width", 200}, {"height", 20}}},
+             {"isRequired", true}, {"id", "name_field"}},
+            {{"fieldType", "Textbox"}, {"pageNumber", 1},
+             {"bounds", {{"x", 100}, {"y", 250}, {"width", 200}, {"height", 20}}},
+             {"isRequired", true}, {"id", "email_field"}},
+            {{"fieldType", "Textbox"}, {"pageNumber", 1},
+             {"bounds", {{"x", 100}, {"y", 300}, {"width", 200}, {"height", 20}}},
+             {"isRequired", true}, {"id", "phone_field"}},
+            {{"fieldType", "Signature"}, {"pageNumber", 1},
+             {"bounds", {{"x", 100}, {"y", 400}, {"width", 200}, {"height", 60}}},
+             {"isRequired", true}, {"id", "signature_field"}}
+        });
+        for (auto& field : fields) {
+            if (values.contains(field["id"])) field["value"] = values[field["id"].get<std::string>()];
+        }
+        return fields;
+    }
+
+    // BoldSign processes documents asynchronously: a signing link asked for
+    // within `processing_time` of creating the document may not work yet
+    static constexpr std::chrono::milliseconds processing_time{1000};
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> processing;  // documentId -> ready
+    std::mutex processing_mutex;
+
+    // BoldSign uses the documentId for both the request and the signature
+    ProviderDocument created(const json& api_response) {
+        if (!api_response.contains("documentId")) {
+            throw std::runtime_error("No documentId in BoldSign response");
+        }
+        std::string id = api_response["documentId"];
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(processing_mutex);
+        for (auto it = processing.begin(); it != processing.end();) {
+            it = it->second <= now ? processing.erase(it) : std::next(it);
+        }
+        processing[id] = now + processing_time;
+        return {id, id};
+    }
+
+    // Sleeps for whatever is left of a new document's processing time, so
+    // work done since creating it counts towards the wait. Documents not
+    // created in the last `processing_time` are ready.
+    void wait_until_processed(const std::string& document_id) {
+        std::chrono::steady_clock::time_point ready;
+        {
+            std::lock_guard<std::mutex> lock(processing_mutex);
+            auto it = processing.find(document_id);
+            if (it == processing.end()) return;
+            ready = it->second;
+        }
+        std::this_thread::sleep_until(ready);
+    }
+};
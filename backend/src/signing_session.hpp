@@ -0,0 +1,197 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <optional>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <cctype>
+#include "session_id.hpp"
+
+enum class SessionStatus : uint8_t { Pending, Signed };
+constexpr size_t session_status_count = 2;
+
+inline const char* to_string(SessionStatus status) {
+    return status == SessionStatus::Signed ? "signed" : "pending";
+}
+
+inline std::optional<SessionStatus> parse_session_status(std::string_view text) {
+    if (text == "pending") return SessionStatus::Pending;
+    if (text == "signed") return SessionStatus::Signed;
+    return std::nullopt;
+}
+
+// 32-bit session timestamps: seconds since 2024-01-01T00:00:00Z (good until 2160).
+// Anchored to the wall clock once at startup and advanced with steady_clock,
+// so values never go backwards inside a process.
+class SessionClock {
+public:
+    static constexpr int64_t epoch_unix = 1704067200;
+
+    static uint32_t now() {
+        static const int64_t wall_base = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count() - epoch_unix;
+        static const auto steady_base = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now() - steady_base).count();
+        return static_cast<uint32_t>(wall_base + elapsed);
+    }
+
+    static int64_t to_unix(uint32_t t) { return epoch_unix + t; }
+
+    // Clamps Unix seconds into the 32-bit range (for query bounds)
+    static uint32_t from_unix(int64_t unix_seconds) {
+        if (unix_seconds <= epoch_unix) return 0;
+        if (unix_seconds - epoch_unix > UINT32_MAX) return UINT32_MAX;
+        return static_cast<uint32_t>(unix_seconds - epoch_unix);
+    }
+};
+
+// Normalized form used to index and compare signer addresses
+inline std::string normalize_email(std::string_view email) {
+    std::string normalized(email);
+    for (auto& c : normalized) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return normalized;
+}
+
+// Read-only view over a packed field block: [5 x uint16 end offsets][bytes].
+// The same layout is used in memory and in snapshot files.
+class PackedFields {
+public:
+    enum Field { RequestId, SignatureId, SignerName, SignerEmail, SignerPhone, field_count };
+    static constexpr size_t header_size = field_count * sizeof(uint16_t);
+
+    explicit PackedFields(const char* block = nullptr) : block(block) {}
+
+    std::string_view get(Field f) const {
+        if (!block) return {};
+        uint16_t begin = f == 0 ? 0 : end_offset(f - 1);
+        return std::string_view(block + header_size + begin, end_offset(f) - begin);
+    }
+
+    size_t size() const { return block ? header_size + end_offset(field_count - 1) : 0; }
+    std::string_view bytes() const { return std::string_view(block, size()); }
+
+    // Whether `bytes` is exactly one well-formed block
+    static bool valid(std::string_view bytes) {
+        if (bytes.size() < header_size) return false;
+        uint16_t previous = 0;
+        for (size_t i = 0; i < field_count; i++) {
+            uint16_t end;
+            std::memcpy(&end, bytes.data() + i * sizeof(uint16_t), sizeof(end));
+            if (end < previous) return false;
+            previous = end;
+        }
+        return header_size + previous == bytes.size();
+    }
+
+private:
+    const char* block;
+
+    uint16_t end_offset(size_t i) const {
+        uint16_t end;
+        std::memcpy(&end, block + i * sizeof(uint16_t), sizeof(end));
+        return end;
+    }
+};
+
+// A session's contents without ownership: what the store hands to visitors,
+// whether the session lives in memory or in a mapped snapshot
+struct SessionRecordRef {
+    SessionId id;
+    uint32_t created_at;
+    SessionStatus status;
+    PackedFields fields;
+    uint8_t provider = 0;
+};
+
+// One session in 32 bytes: the ID and timestamp inline, one-byte status and
+// provider, and every variable-length field (provider IDs and signer details) packed into a
+// single heap block (see PackedFields).
+class SigningSession {
+public:
+    SessionId id;
+    uint32_t created_at = 0;  // SessionClock seconds
+    SessionStatus status = SessionStatus::Pending;
+    uint8_t provider = 0;  // ProviderRouter ID of the document's provider (0 = default)
+
+    SigningSession() = default;
+    SigningSession(SigningSession&&) noexcept = default;
+    SigningSession& operator=(SigningSession&&) noexcept = default;
+
+    SigningSession(const SigningSession& other)
+        : id(other.id), created_at(other.created_at), status(other.status), provider(other.provider) {
+        if (other.packed) set_packed(other.fields().bytes());
+    }
+
+    SigningSession& operator=(const SigningSession& other) {
+        if (this != &other) {
+            SigningSession copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    // Copies a session out of a record reference (e.g. from a snapshot)
+    static SigningSession from_ref(const SessionRecordRef& ref) {
+        SigningSession session;
+        session.id = ref.id;
+        session.created_at = ref.created_at;
+        session.status = ref.status;
+        session.provider = ref.provider;
+        session.set_packed(ref.fields.bytes());
+        return session;
+    }
+
+    // Throws std::length_error if the fields add up to more than 64 KB
+    void set_fields(std::string_view signature_request_id, std::string_view signature_id,
+                    std::string_view signer_name, std::string_view signer_email,
+                    std::string_view signer_phone) {
+        const std::string_view values[PackedFields::field_count] = {
+            signature_request_id, signature_id, signer_name, signer_email, signer_phone
+        };
+        size_t total = 0;
+        for (auto v : values) total += v.size();
+        if (total > UINT16_MAX) throw std::length_error("Session fields too long");
+
+        std::unique_ptr<char[]> block(new char[PackedFields::header_size + total]);
+        uint16_t end = 0;
+        char* data = block.get() + PackedFields::header_size;
+        for (size_t i = 0; i < PackedFields::field_count; i++) {
+            std::memcpy(data + end, values[i].data(), values[i].size());
+            end = static_cast<uint16_t>(end + values[i].size());
+            std::memcpy(block.get() + i * sizeof(uint16_t), &end, sizeof(end));
+        }
+        packed = std::move(block);
+    }
+
+    std::string_view signature_request_id() const { return fields().get(PackedFields::RequestId); }
+    std::string_view signature_id() const { return fields().get(PackedFields::SignatureId); }
+    std::string_view signer_name() const { return fields().get(PackedFields::SignerName); }
+    std::string_view signer_email() const { return fields().get(PackedFields::SignerEmail); }
+    std::string_view signer_phone() const { return fields().get(PackedFields::SignerPhone); }
+
+    PackedFields fields() const { return PackedFields(packed.get()); }
+    SessionRecordRef ref() const { return {id, created_at, status, fields(), provider}; }
+
+    // Heap bytes owned by this session (for memory accounting)
+    size_t packed_size() const { return fields().size(); }
+
+private:
+    std::unique_ptr<char[]> packed;
+
+    // `bytes` must be a valid block (PackedFields::valid)
+    void set_packed(std::string_view bytes) {
+        if (bytes.empty()) {
+            packed.reset();
+            return;
+        }
+        packed.reset(new char[bytes.size()]);
+        std::memcpy(packed.get(), bytes.data(), bytes.size());
+    }
+};
+
+static_assert(sizeof(SigningSession) <= 32, "SigningSession should stay compact");
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <ctime>
+#include "httplib.h"
+#include "http_util.hpp"
+#include "compression.hpp"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+// In-memory copy of public/ with precompressed variants.
+// The whole directory is loaded at startup and swapped atomically on reload,
+// so request handlers never touch the disk.
+class StaticAssetCache {
+private:
+    struct Variant {
+        std::string data;
+        std::string etag;
+    };
+
+    struct Asset {
+        std::string content_type;
+        std::string hash;
+        std::time_t last_modified = 0;
+        Variant identity;
+        Variant gzip;    // empty when not worth it or codec unavailable
+        Variant brotli;
+    };
+
+    using AssetMap = std::unordered_map<std::string, std::shared_ptr<const Asset>>;
+
+    std::string root;
+    std::shared_ptr<const AssetMap> assets;
+    std::mutex assets_mutex;
+    std::atomic<bool> running{false};
+    std::thread watcher;
+
+    static std::string content_type_for(const std::string& path) {
+        static const std::unordered_map<std::string, std::string> types = {
+            {".html", "text/html"}, {".htm", "text/html"},
+            {".css", "text/css"}, {".js", "application/javascript"},
+            {".json", "application/json"}, {".svg", "image/svg+xml"},
+            {".png", "image/png"}, {".jpg", "image/jpeg"}, {".jpeg", "image/jpeg"},
+            {".gif", "image/gif"}, {".ico", "image/x-icon"}, {".webp", "image/webp"},
+            {".txt", "text/plain"}, {".pdf", "application/pdf"},
+            {".woff", "font/woff"}, {".woff2", "font/woff2"}
+        };
+        auto dot = path.find_last_of('.');
+        if (dot != std::string::npos) {
+            auto it = types.find(path.substr(dot));
+            if (it != types.end()) return it->second;
+        }
+        return "application/octet-stream";
+    }
+
+    static std::shared_ptr<const Asset> build_asset(const std::filesystem::path& file) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in) return nullptr;
+
+        auto asset = std::make_shared<Asset>();
+        asset->identity.data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        asset->content_type = content_type_for(file.string());
+        asset->hash = sha256_hex(asset->identity.data).substr(0, 32);
+        asset->identity.etag = "\"" + asset->hash + "\"";
+
+        std::error_code ec;
+        auto mtime = std::filesystem::last_write_time(file, ec);
+        if (!ec) {
+            auto sys = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+                mtime - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now());
+            asset->last_modified = std::chrono::system_clock::to_time_t(sys);
+        } else {
+            asset->last_modified = std::time(nullptr);
+        }
+
+        // Precompress with the slowest/best settings: this runs once per reload
+        if (is_compressible_content_type(asset->content_type) && asset->identity.data.size() > 256) {
+            const size_t worth_it = asset->identity.data.size() * 9 / 10;
+#ifdef SIGNING_HAVE_ZLIB
+            std::string gz = compress_gzip(asset->identity.data);
+            if (gz.size() < worth_it) {
+                asset->gzip.data = std::move(gz);
+                asset->gzip.etag = "\"" + asset->hash + "-gzip\"";
+            }
+#endif
+#ifdef SIGNING_HAVE_BROTLI
+            std::string br = compress_brotli(asset->identity.data);
+            if (br.size() < worth_it) {
+                asset->brotli.data = std::move(br);
+                asset->brotli.etag = "\"" + asset->hash + "-br\"";
+            }
+#endif
+        }
+        return asset;
+    }
+
+    std::shared_ptr<const AssetMap> snapshot() {
+        std::lock_guard<std::mutex> lock(assets_mutex);
+        return assets;
+    }
+
+#ifdef __linux__
+    void add_watches(int fd) {
+        const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+        inotify_add_watch(fd, root.c_str(), mask);
+        std::error_code ec;
+        for (auto it = std::filesystem::recursive_directory_iterator(root, ec);
+             !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            if (it->is_directory()) inotify_add_watch(fd, it->path().c_str(), mask);
+        }
+    }
+
+    void watch_loop() {
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            std::cout << "Warning: inotify unavailable, static assets will not auto-reload" << std::endl;
+            return;
+        }
+        add_watches(fd);
+
+        char buf[4096];
+        while (running) {
+            pollfd pfd{fd, POLLIN, 0};
+            if (poll(&pfd, 1, 500) <= 0) continue;
+
+            // Drain the queue, then wait briefly so an editor's write/rename burst
+            // results in a single reload
+            while (read(fd, buf, sizeof(buf)) > 0) {}
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            while (read(fd, buf, sizeof(buf)) > 0) {}
+
+            reload();
+            add_watches(fd);  // picks up new subdirectories; existing ones are no-ops
+        }
+        close(fd);
+    }
+#endif
+
+public:
+    explicit StaticAssetCache(std::string root_dir) : root(std::move(root_dir)) {
+        reload();
+    }
+
+    ~StaticAssetCache() {
+        running = false;
+        if (watcher.joinable()) watcher.join();
+    }
+
+    void reload() {
+        auto fresh = std::make_shared<AssetMap>();
+        size_t bytes = 0;
+
+        std::error_code ec;
+        for (auto it = std::filesystem::recursive_directory_iterator(root, ec);
+             !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            if (!it->is_regular_file()) continue;
+            auto asset = build_asset(it->path());
+            if (!asset) continue;
+
+            std::string url = "/" + std::filesystem::relative(it->path(), root).generic_string();
+            bytes += asset->identity.data.size() + asset->gzip.data.size() + asset->brotli.data.size();
+            (*fresh)[url] = asset;
+        }
+
+        std::lock_guard<std::mutex> lock(assets_mutex);
+        assets = fresh;
+        std::cout << "Static assets loaded: " << fresh->size() << " files, "
+                  << bytes << " bytes in memory" << std::endl;
+    }
+
+    void start_watching() {
+#ifdef __linux__
+        if (running.exchange(true)) return;
+        watcher = std::thread([this] { watch_loop(); });
+#endif
+    }
+
+    // Returns false when the path is not a known asset
+    bool serve(const httplib::Request& req, httplib::Response& res) {
+        auto current = snapshot();
+
+        std::string path = req.path;
+        if (!path.empty() && path.back() == '/') path += "index.html";
+        auto it = current->find(path);
+        if (it == current->end()) return false;
+        auto asset = it->second;
+
+        // Pick the smallest variant the client accepts
+        ContentEncoding encoding = negotiate_encoding(
+            req.get_header_value("Accept-Encoding"),
+            {asset->brotli.data.empty() ? ContentEncoding::Identity : ContentEncoding::Brotli,
+             asset->gzip.data.empty() ? ContentEncoding::Identity : ContentEncoding::Gzip});
+        const Variant* variant = &asset->identity;
+        if (encoding == ContentEncoding::Brotli) variant = &asset->brotli;
+        else if (encoding == ContentEncoding::Gzip) variant = &asset->gzip;
+
+        // URLs carrying the content hash (?v=<hash>) never change; everything else
+        // is revalidated so edits show up immediately
+        if (req.get_param_value("v") == asset->hash) {
+            res.set_header("Cache-Control", "public, max-age=31536000, immutable");
+        } else {
+            res.set_header("Cache-Control", "no-cache");
+        }
+        res.set_header("ETag", variant->etag);
+        res.set_header("Last-Modified", format_http_date(asset->last_modified));
+        res.set_header("Vary", "Accept-Encoding");
+
+        if (etag_list_matches(req.get_header_value("If-None-Match"), variant->etag)) {
+            res.status = 304;
+            return true;
+        }
+
+        if (encoding != ContentEncoding::Identity) {
+            res.set_header("Content-Encoding", content_encoding_token(encoding));
+        }
+        if (variant->data.empty()) {
+            res.set_content("", asset->content_type);
+            return true;
+        }
+        // The provider keeps the snapshot entry alive; nothing is copied
+        res.set_content_provider(
+            variant->data.size(), asset->content_type,
+            [asset, variant](size_t offset, size_t length, httplib::DataSink& sink) {
+                return sink.write(variant->data.data() + offset, length);
+            });
+        return true;
+    }
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <utility>
+#include <unordered_map>
+#include <mutex>
+#include <chrono>
+#include "session_id.hpp"
+
+// When each pending session's status was last confirmed with the provider, so
+// polls within `max_age` are answered from the store. Signed is terminal and
+// never rechecked, so only pending sessions need entries. Stale entries carry
+// no information: every check is also queued in the order it happened, which
+// is the order entries go stale, so each mark prunes from the front of the
+// queue in time proportional to what it removes.
+class StatusFreshness {
+public:
+    StatusFreshness(std::chrono::milliseconds max_age, size_t max_entries = 100000)
+        : max_age(max_age), max_entries(max_entries) {}
+
+    bool is_fresh(const SessionId& id) {
+        if (max_age.count() <= 0) return false;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = checked.find(id);
+        return it != checked.end() && std::chrono::steady_clock::now() - it->second < max_age;
+    }
+
+    void mark_checked(const SessionId& id) {
+        if (max_age.count() <= 0) return;
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!order.empty() && now - order.front().second >= max_age) {
+            // A later check or a forget() may have superseded the queued one
+            auto it = checked.find(order.front().first);
+            if (it != checked.end() && it->second == order.front().second) checked.erase(it);
+            order.pop_front();
+        }
+        if (checked.size() >= max_entries && checked.find(id) == checked.end()) return;  // all fresh: skip this one
+        checked[id] = now;
+        order.emplace_back(id, now);
+    }
+
+    void forget(const std::vector<SessionId>& ids) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& id : ids) checked.erase(id);
+    }
+
+private:
+    std::chrono::milliseconds max_age;
+    size_t max_entries;
+    std::unordered_map<SessionId, std::chrono::steady_clock::time_point, SessionIdHash> checked;
+    std::deque<std::pair<SessionId, std::chrono::steady_clock::time_point>> order;  // oldest check first
+    std::mutex mutex;
+};
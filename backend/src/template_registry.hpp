@@ -0,0 +1,104 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <fstream>
+#include <cstdio>
+#include <iostream>
+#include "json.hpp"
+
+// Provider-side templates for the documents we send, so creating a session
+// references a template ID instead of uploading the PDF each time. IDs are
+// keyed by a caller-chosen document key (provider + content hash) and, given a
+// path, saved to a small JSON file so restarts reuse them. Registration is
+// single-flight: concurrent callers for the same key wait for one upload
+// rather than each creating a template.
+class TemplateRegistry {
+public:
+    using Register = std::function<std::string()>;
+
+    explicit TemplateRegistry(std::string path = "") : path(std::move(path)) {
+        if (this->path.empty()) return;
+        std::ifstream file(this->path);
+        if (!file) return;
+        try {
+            auto saved = nlohmann::json::parse(file);
+            for (auto it = saved.begin(); it != saved.end(); ++it) {
+                if (it.value().is_string()) ids[it.key()] = it.value().get<std::string>();
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Ignoring unreadable template cache " << this->path << ": " << e.what() << std::endl;
+        }
+    }
+
+    // The template ID for `key`, calling `create` (which uploads the document
+    // and returns the new ID) if there is none yet. Errors from `create`
+    // propagate; the next caller tries again.
+    std::string get_or_register(const std::string& key, const Register& create) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            auto it = ids.find(key);
+            if (it != ids.end()) return it->second;
+            if (registering.insert(key).second) break;
+            registered.wait(lock);
+        }
+
+        lock.unlock();
+        std::string id;
+        try {
+            id = create();
+        } catch (...) {
+            lock.lock();
+            registering.erase(key);
+            registered.notify_all();
+            throw;
+        }
+
+        lock.lock();
+        registering.erase(key);
+        ids[key] = id;
+        save_locked();
+        registered.notify_all();
+        return id;
+    }
+
+    // Forgets a template the provider no longer knows about
+    void invalidate(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ids.erase(key)) save_locked();
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return ids.size();
+    }
+
+private:
+    std::string path;
+    std::unordered_map<std::string, std::string> ids;
+    std::unordered_set<std::string> registering;
+    std::mutex mutex;
+    std::condition_variable registered;
+
+    // Rewrites the whole file (a handful of entries) via rename, so a crash
+    // leaves either the old or the new version
+    void save_locked() {
+        if (path.empty()) return;
+        std::string temp_path = path + ".tmp";
+        {
+            std::ofstream file(temp_path, std::ios::trunc);
+            file << nlohmann::json(ids).dump(2) << "\n";
+            if (!file) {
+                std::cerr << "Failed to write template cache " << temp_path << std::endl;
+                return;
+            }
+        }
+        if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+            std::cerr << "Failed to replace template cache " << path << std::endl;
+        }
+    }
+};
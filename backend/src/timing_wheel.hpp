@@ -0,0 +1,156 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+// Hierarchical timing wheel (4 levels x 64 slots) over integer ticks.
+// schedule() and cancel() are O(1); advance() does O(1) work per tick plus
+// O(1) per timer that fires or moves down a level. With one-second ticks it
+// covers ~194 days exactly; longer timeouts are parked in the top level and
+// re-placed as time passes.
+//
+// Not thread-safe: the owner serializes access.
+template <typename Key>
+class TimingWheel {
+public:
+    using Handle = uint32_t;
+    static constexpr Handle invalid_handle = std::numeric_limits<uint32_t>::max();
+
+    explicit TimingWheel(uint64_t start_tick = 0) : current(start_tick) {
+        for (auto& level : heads) {
+            for (auto& head : level) head = nil;
+        }
+    }
+
+    Handle schedule(const Key& key, uint64_t expires_at) {
+        uint32_t index;
+        if (!free_list.empty()) {
+            index = free_list.back();
+            free_list.pop_back();
+        } else {
+            index = static_cast<uint32_t>(nodes.size());
+            nodes.emplace_back();
+        }
+
+        Node& node = nodes[index];
+        node.key = key;
+        // Anything already due fires on the next tick
+        node.expires = expires_at > current ? expires_at : current + 1;
+        node.active = true;
+        link(index);
+        active_count++;
+        return index;
+    }
+
+    void cancel(Handle handle) {
+        if (handle >= nodes.size() || !nodes[handle].active) return;
+        unlink(handle);
+        release(handle);
+    }
+
+    // Moves time forward to `now`, appending the keys of every timer that
+    // expired on the way to `out`.
+    void advance(uint64_t now, std::vector<Key>& out) {
+        while (current < now) {
+            current++;
+
+            // When a lower level wraps, pull the matching slot of the level above
+            // down; cascading from the top keeps timers moving one level at a time
+            for (int level = levels - 1; level > 0; level--) {
+                uint64_t lower_mask = (uint64_t(1) << (bits * level)) - 1;
+                if ((current & lower_mask) == 0) {
+                    cascade(level, (current >> (bits * level)) & slot_mask);
+                }
+            }
+
+            uint32_t index = heads[0][current & slot_mask];
+            heads[0][current & slot_mask] = nil;
+            while (index != nil) {
+                uint32_t next = nodes[index].next;
+                if (nodes[index].expires <= current) {
+                    out.push_back(nodes[index].key);
+                    release(index);
+                } else {
+                    link(index);
+                }
+                index = next;
+            }
+        }
+    }
+
+    uint64_t now() const { return current; }
+    size_t size() const { return active_count; }
+
+private:
+    static constexpr int levels = 4;
+    static constexpr int bits = 6;
+    static constexpr uint32_t slots = 1u << bits;
+    static constexpr uint64_t slot_mask = slots - 1;
+    static constexpr uint32_t nil = std::numeric_limits<uint32_t>::max();
+
+    struct Node {
+        Key key{};
+        uint64_t expires = 0;
+        uint32_t prev = nil;
+        uint32_t next = nil;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        bool active = false;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> free_list;
+    uint32_t heads[levels][slots];
+    uint64_t current;
+    size_t active_count = 0;
+
+    void link(uint32_t index) {
+        Node& node = nodes[index];
+        uint64_t delta = node.expires - current;
+
+        int level = 0;
+        while (level < levels - 1 && delta >= (uint64_t(1) << (bits * (level + 1)))) level++;
+
+        uint64_t target = node.expires;
+        uint64_t max_delta = (uint64_t(1) << (bits * levels)) - 1;
+        if (delta > max_delta) target = current + max_delta;  // re-placed on cascade
+
+        node.level = static_cast<uint8_t>(level);
+        node.slot = static_cast<uint8_t>((target >> (bits * level)) & slot_mask);
+        node.prev = nil;
+        node.next = heads[level][node.slot];
+        if (node.next != nil) nodes[node.next].prev = index;
+        heads[level][node.slot] = index;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = nodes[index];
+        if (node.prev != nil) {
+            nodes[node.prev].next = node.next;
+        } else {
+            heads[node.level][node.slot] = node.next;
+        }
+        if (node.next != nil) nodes[node.next].prev = node.prev;
+        node.prev = node.next = nil;
+    }
+
+    void release(uint32_t index) {
+        nodes[index].active = false;
+        nodes[index].key = Key{};
+        free_list.push_back(index);
+        active_count--;
+    }
+
+    void cascade(int level, uint64_t slot) {
+        uint32_t index = heads[level][slot];
+        heads[level][slot] = nil;
+        while (index != nil) {
+            uint32_t next = nodes[index].next;
+            if (nodes[index].expires <= current) nodes[index].expires = current;
+            link(index);
+            index = next;
+        }
+    }
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ctime>
+#include <cstdint>
+#include "checksum.hpp"
+
+// Writes a ZIP archive front to back so it can be streamed while it is built:
+// each entry is a local header followed by the caller's bytes, written as-is
+// (method "stored" - signed PDFs don't compress), and finish() emits the
+// central directory. Only the directory entries (name, CRC, size, offset) are
+// kept, never the data. ZIP64 fields are used once sizes, offsets or the entry
+// count outgrow the classic 32/16-bit limits.
+class ZipStreamWriter {
+public:
+    // Records an entry and returns its local header; the caller writes the
+    // header and then exactly `size` bytes of `data`
+    std::string entry_header(const std::string& name, const char* data, size_t size, std::time_t mtime) {
+        Entry entry{name, crc32_ieee(data, size), size, offset, 0, 0};
+        dos_time(mtime, entry.time, entry.date);
+        bool zip64 = size >= UINT32_MAX;
+
+        std::string out;
+        put32(out, 0x04034b50);
+        put16(out, zip64 ? 45 : 20);  // version needed
+        put16(out, 0x0800);           // UTF-8 names
+        put16(out, 0);                // stored
+        put16(out, entry.time);
+        put16(out, entry.date);
+        put32(out, entry.crc);
+        put32(out, zip64 ? UINT32_MAX : static_cast<uint32_t>(size));
+        put32(out, zip64 ? UINT32_MAX : static_cast<uint32_t>(size));
+        put16(out, static_cast<uint16_t>(name.size()));
+        put16(out, zip64 ? 20 : 0);
+        out += name;
+        if (zip64) {
+            put16(out, 0x0001);
+            put16(out, 16);
+            put64(out, size);
+            put64(out, size);
+        }
+
+        offset += out.size() + size;
+        entries.push_back(std::move(entry));
+        return out;
+    }
+
+    // The central directory and end records; nothing may be added afterwards
+    std::string finish() const {
+        std::string out;
+        for (const Entry& entry : entries) {
+            bool big_size = entry.size >= UINT32_MAX;
+            bool big_offset = entry.offset >= UINT32_MAX;
+            std::string extra;
+            if (big_size || big_offset) {
+                put16(extra, 0x0001);
+                put16(extra, static_cast<uint16_t>((big_size ? 16 : 0) + (big_offset ? 8 : 0)));
+                if (big_size) {
+                    put64(extra, entry.size);
+                    put64(extra, entry.size);
+                }
+                if (big_offset) put64(extra, entry.offset);
+            }
+
+            put32(out, 0x02014b50);
+            put16(out, 45);  // version made by
+            put16(out, extra.empty() ? 20 : 45);
+            put16(out, 0x0800);
+            put16(out, 0);
+            put16(out, entry.time);
+            put16(out, entry.date);
+            put32(out, entry.crc);
+            put32(out, big_size ? UINT32_MAX : static_cast<uint32_t>(entry.size));
+            put32(out, big_size ? UINT32_MAX : static_cast<uint32_t>(entry.size));
+            put16(out, static_cast<uint16_t>(entry.name.size()));
+            put16(out, static_cast<uint16_t>(extra.size()));
+            put16(out, 0);  // comment
+            put16(out, 0);  // disk
+            put16(out, 0);  // internal attributes
+            put32(out, 0);  // external attributes
+            put32(out, big_offset ? UINT32_MAX : static_cast<uint32_t>(entry.offset));
+            out += entry.name;
+            out += extra;
+        }
+
+        uint64_t directory_offset = offset;
+        uint64_t directory_size = out.size();
+        bool zip64 = entries.size() >= UINT16_MAX || directory_offset >= UINT32_MAX ||
+                     directory_size >= UINT32_MAX;
+        if (zip64) {
+            uint64_t record_offset = directory_offset + directory_size;
+            put32(out, 0x06064b50);
+            put64(out, 44);  // size of the rest of this record
+            put16(out, 45);
+            put16(out, 45);
+            put32(out, 0);
+            put32(out, 0);
+            put64(out, entries.size());
+            put64(out, entries.size());
+            put64(out, directory_size);
+            put64(out, directory_offset);
+
+            put32(out, 0x07064b50);
+            put32(out, 0);
+            put64(out, record_offset);
+            put32(out, 1);
+        }
+
+        uint16_t count = zip64 ? UINT16_MAX : static_cast<uint16_t>(entries.size());
+        put32(out, 0x06054b50);
+        put16(out, 0);
+        put16(out, 0);
+        put16(out, count);
+        put16(out, count);
+        put32(out, zip64 ? UINT32_MAX : static_cast<uint32_t>(directory_size));
+        put32(out, zip64 ? UINT32_MAX : static_cast<uint32_t>(directory_offset));
+        put16(out, 0);
+        return out;
+    }
+
+    size_t entry_count() const { return entries.size(); }
+
+private:
+    struct Entry {
+        std::string name;
+        uint32_t crc;
+        uint64_t size;
+        uint64_t offset;
+        uint16_t time;
+        uint16_t date;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t offset = 0;
+
+    static void put16(std::string& out, uint16_t v) {
+        out += static_cast<char>(v & 0xFF);
+        out += static_cast<char>(v >> 8);
+    }
+    static void put32(std::string& out, uint32_t v) {
+        put16(out, static_cast<uint16_t>(v & 0xFFFF));
+        put16(out, static_cast<uint16_t>(v >> 16));
+    }
+    static void put64(std::string& out, uint64_t v) {
+        put32(out, static_cast<uint32_t>(v & 0xFFFFFFFFu));
+        put32(out, static_cast<uint32_t>(v >> 32));
+    }
+
+    // MS-DOS timestamps (local time, 2-second resolution, 1980 onwards)
+    static void dos_time(std::time_t t, uint16_t& time, uint16_t& date) {
+        std::tm tm{};
+#ifdef _WIN32
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+        if (tm.tm_year < 80) {
+            time = 0;
+            date = (1 << 5) | 1;  // 1980-01-01
+            return;
+        }
+        time = static_cast<uint16_t>((tm.tm_hour << 11) | (tm.tm_min << 5) | (tm.tm_sec / 2));
+        date = static_cast<uint16_t>(((tm.tm_year - 80) << 9) | ((tm.tm_mon + 1) << 5) | tm.tm_mday);
+    }
+};
@@ -8,10 +8,11 @@ mkdir -p build
 # Compile the server
 g++ -std=c++17 -O2 -pthread \
     -DCPPHTTPLIB_OPENSSL_SUPPORT \
+    -DSIGNING_HAVE_ZLIB \
     -I backend/include \
     backend/src/main.cpp \
     -o build/signing-server \
-    -lssl -lcrypto
+    -lssl -lcrypto -lz
 
 if [ $? -eq 0 ]; then
     echo "Build successful!"